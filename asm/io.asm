@@ -0,0 +1,167 @@
+; buffered stdin/stdout shared by the long arithmetic programs:
+; input is read by blocks of IN_BUFFER_SIZE bytes,
+; output is written when the buffer is full or on exit
+IN_BUFFER_SIZE  equ             64 * 1024
+OUT_BUFFER_SIZE equ             64 * 1024
+
+                section         .text
+
+                global          read_char
+                global          write_char
+                global          print_string
+                global          flush_output
+                global          exit
+
+; read one char from stdin
+; modifies:
+;    none
+; result:
+;    rax == -1 if error occurs or input is over
+;    rax \in [0; 255] if OK
+read_char:
+                mov             rax, [in_pos]
+                cmp             rax, [in_end]
+                jae             .refill
+.take:
+                inc             qword [in_pos]
+                movzx           eax, byte [in_buffer + rax]
+                ret
+
+.refill:
+                push            rcx
+                push            rdx
+                push            rsi
+                push            rdi
+                push            r11
+
+                xor             rax, rax
+                xor             rdi, rdi
+                mov             rsi, in_buffer
+                mov             rdx, IN_BUFFER_SIZE
+                syscall
+
+                pop             r11
+                pop             rdi
+                pop             rsi
+                pop             rdx
+                pop             rcx
+
+                test            rax, rax
+                jle             .error
+                mov             [in_end], rax
+                xor             rax, rax
+                mov             [in_pos], rax
+                jmp             .take
+.error:
+                mov             rax, -1
+                ret
+
+; write one char to stdout, errors are ignored
+;    al -- char
+; modifies:
+;    none
+write_char:
+                push            rcx
+
+                mov             rcx, [out_pos]
+                cmp             rcx, OUT_BUFFER_SIZE
+                jb              .store
+                call            flush_output
+                xor             rcx, rcx
+.store:
+                mov             [out_buffer + rcx], al
+                inc             rcx
+                mov             [out_pos], rcx
+
+                pop             rcx
+                ret
+
+; print string to stdout
+;    rsi -- string
+;    rdx -- size
+; modifies:
+;    none
+print_string:
+                push            rcx
+                push            rdx
+                push            rsi
+                push            rdi
+
+.loop:
+                test            rdx, rdx
+                jz              .done
+                mov             rcx, OUT_BUFFER_SIZE
+                sub             rcx, [out_pos]
+                jnz             .copy
+                call            flush_output
+                jmp             .loop
+
+.copy:
+                ; rcx = min(free space, rest of the string)
+                cmp             rcx, rdx
+                cmova           rcx, rdx
+                sub             rdx, rcx
+                mov             rdi, [out_pos]
+                add             [out_pos], rcx
+                lea             rdi, [out_buffer + rdi]
+                rep movsb
+                jmp             .loop
+
+.done:
+                pop             rdi
+                pop             rsi
+                pop             rdx
+                pop             rcx
+                ret
+
+; write buffered output to stdout, errors are ignored
+; modifies:
+;    none
+flush_output:
+                push            rax
+                push            rcx
+                push            rdx
+                push            rsi
+                push            rdi
+                push            r11
+
+                mov             rsi, out_buffer
+                mov             rdx, [out_pos]
+.loop:
+                test            rdx, rdx
+                jz              .done
+                mov             rax, 1
+                mov             rdi, 1
+                syscall
+                test            rax, rax
+                jle             .done
+                add             rsi, rax
+                sub             rdx, rax
+                jmp             .loop
+
+.done:
+                mov             qword [out_pos], 0
+
+                pop             r11
+                pop             rdi
+                pop             rsi
+                pop             rdx
+                pop             rcx
+                pop             rax
+                ret
+
+; flush output and exit with code 0
+exit:
+                call            flush_output
+
+                mov             rax, 60
+                xor             rdi, rdi
+                syscall
+
+
+                section         .bss
+in_pos:         resq            1
+in_end:         resq            1
+out_pos:        resq            1
+in_buffer:      resb            IN_BUFFER_SIZE
+out_buffer:     resb            OUT_BUFFER_SIZE
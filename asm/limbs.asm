@@ -0,0 +1,373 @@
+; long arithmetic kernels callable from C (see limbs.h):
+; all functions follow System V AMD64 ABI, long numbers are arrays of qwords (lowest first)
+; with explicit length, result may coincide with an operand if it starts at the same qword.
+; mulx/adcx/adox variants are selected by CPUID on the first call
+
+                section         .text
+
+                global          asm_add_long_long
+                global          asm_sub_long_long
+                global          asm_mul_long_short
+                global          asm_mul_long_short_mul
+                global          asm_mul_long_short_mulx
+                global          asm_add_long_mul_long_short
+                global          asm_add_long_mul_long_short_mul
+                global          asm_add_long_mul_long_short_adx
+                global          asm_div_long_short
+                global          asm_cpu_features
+
+; adds two long numbers
+;    rdi -- address of result (long number)
+;    rsi -- address of summand #1 (long number)
+;    rdx -- address of summand #2 (long number)
+;    rcx -- length of long numbers in qwords
+; result:
+;    rax -- carry
+asm_add_long_long:
+                ; rcx % 4 qwords are added one by one, then by four
+                mov             r8, rcx
+                shr             r8, 2
+                and             ecx, 3          ; CF = 0
+                jrcxz           .quads
+.single:
+                mov             rax, [rsi]
+                adc             rax, [rdx]
+                mov             [rdi], rax
+                lea             rsi, [rsi + 8]
+                lea             rdx, [rdx + 8]
+                lea             rdi, [rdi + 8]
+                dec             rcx
+                jnz             .single
+
+.quads:
+                mov             rcx, r8
+                jrcxz           .done
+.quad:
+                mov             rax, [rsi]
+                adc             rax, [rdx]
+                mov             [rdi], rax
+                mov             r9, [rsi + 8]
+                adc             r9, [rdx + 8]
+                mov             [rdi + 8], r9
+                mov             r10, [rsi + 16]
+                adc             r10, [rdx + 16]
+                mov             [rdi + 16], r10
+                mov             r11, [rsi + 24]
+                adc             r11, [rdx + 24]
+                mov             [rdi + 24], r11
+                lea             rsi, [rsi + 32]
+                lea             rdx, [rdx + 32]
+                lea             rdi, [rdi + 32]
+                dec             rcx
+                jnz             .quad
+
+.done:
+                mov             eax, 0
+                adc             eax, 0
+                ret
+
+; subtracts two long numbers
+;    rdi -- address of result (long number)
+;    rsi -- address of minuend (long number)
+;    rdx -- address of subtrahend (long number)
+;    rcx -- length of long numbers in qwords
+; result:
+;    rax -- borrow
+asm_sub_long_long:
+                mov             r8, rcx
+                shr             r8, 2
+                and             ecx, 3          ; CF = 0
+                jrcxz           .quads
+.single:
+                mov             rax, [rsi]
+                sbb             rax, [rdx]
+                mov             [rdi], rax
+                lea             rsi, [rsi + 8]
+                lea             rdx, [rdx + 8]
+                lea             rdi, [rdi + 8]
+                dec             rcx
+                jnz             .single
+
+.quads:
+                mov             rcx, r8
+                jrcxz           .done
+.quad:
+                mov             rax, [rsi]
+                sbb             rax, [rdx]
+                mov             [rdi], rax
+                mov             r9, [rsi + 8]
+                sbb             r9, [rdx + 8]
+                mov             [rdi + 8], r9
+                mov             r10, [rsi + 16]
+                sbb             r10, [rdx + 16]
+                mov             [rdi + 16], r10
+                mov             r11, [rsi + 24]
+                sbb             r11, [rdx + 24]
+                mov             [rdi + 24], r11
+                lea             rsi, [rsi + 32]
+                lea             rdx, [rdx + 32]
+                lea             rdi, [rdi + 32]
+                dec             rcx
+                jnz             .quad
+
+.done:
+                mov             eax, 0
+                adc             eax, 0
+                ret
+
+; multiplies long number by a short
+;    rdi -- address of result (long number)
+;    rsi -- address of multiplier #1 (long number)
+;    rdx -- length of long number in qwords
+;    rcx -- multiplier #2 (64-bit unsigned)
+; result:
+;    rax -- highest qword of the product
+asm_mul_long_short:
+                jmp             [rel mul_long_short_impl]
+
+asm_mul_long_short_mul:
+                mov             r8, rdx
+                xor             r9, r9
+                test            r8, r8
+                jz              .done
+.loop:
+                mov             rax, [rsi]
+                mul             rcx
+                add             rax, r9
+                adc             rdx, 0
+                mov             [rdi], rax
+                mov             r9, rdx
+                lea             rsi, [rsi + 8]
+                lea             rdi, [rdi + 8]
+                dec             r8
+                jnz             .loop
+
+.done:
+                mov             rax, r9
+                ret
+
+; mulx leaves flags intact, so high halves are carried by a single adc chain, requires BMI2
+asm_mul_long_short_mulx:
+                mov             r8, rdx
+                mov             rdx, rcx
+                mov             rcx, r8
+                shr             r8, 2
+                and             ecx, 3
+                xor             eax, eax        ; rax -- high half of the previous product, CF = 0
+                jrcxz           .quads
+.single:
+                mulx            r9, r10, [rsi]
+                adc             r10, rax
+                mov             [rdi], r10
+                mov             rax, r9
+                lea             rsi, [rsi + 8]
+                lea             rdi, [rdi + 8]
+                dec             rcx
+                jnz             .single
+
+.quads:
+                mov             rcx, r8
+                jrcxz           .done
+.quad:
+                mulx            r9, r10, [rsi]
+                adc             r10, rax
+                mov             [rdi], r10
+                mulx            rax, r11, [rsi + 8]
+                adc             r11, r9
+                mov             [rdi + 8], r11
+                mulx            r9, r10, [rsi + 16]
+                adc             r10, rax
+                mov             [rdi + 16], r10
+                mulx            rax, r11, [rsi + 24]
+                adc             r11, r9
+                mov             [rdi + 24], r11
+                lea             rsi, [rsi + 32]
+                lea             rdi, [rdi + 32]
+                dec             rcx
+                jnz             .quad
+
+.done:
+                adc             rax, 0
+                ret
+
+; multiplies long number by a short and adds result to another long
+;    rdi -- address of summand and result (long number)
+;    rsi -- address of multiplier #1 (long number)
+;    rdx -- length of long numbers in qwords
+;    rcx -- multiplier #2 (64-bit unsigned)
+; result:
+;    rax -- carry out of the highest qword
+asm_add_long_mul_long_short:
+                jmp             [rel add_long_mul_long_short_impl]
+
+asm_add_long_mul_long_short_mul:
+                mov             r8, rdx
+                xor             r9, r9
+                test            r8, r8
+                jz              .done
+.loop:
+                mov             rax, [rsi]
+                mul             rcx
+                add             rax, r9
+                adc             rdx, 0
+                add             [rdi], rax
+                adc             rdx, 0
+                mov             r9, rdx
+                lea             rsi, [rsi + 8]
+                lea             rdi, [rdi + 8]
+                dec             r8
+                jnz             .loop
+
+.done:
+                mov             rax, r9
+                ret
+
+; two independent carry chains: adcx adds high halves of products (CF), adox adds the summand (OF),
+; the loop is counted by lea and jrcxz which keep both flags, requires BMI2 and ADX
+asm_add_long_mul_long_short_adx:
+                mov             r8, rdx
+                mov             rdx, rcx
+                mov             rcx, r8
+                shr             r8, 2
+                and             ecx, 3
+                xor             r11d, r11d
+                xor             eax, eax        ; rax -- high half of the previous product, CF = OF = 0
+.single:
+                jrcxz           .quads
+                mulx            r9, r10, [rsi]
+                adcx            r10, rax
+                adox            r10, [rdi]
+                mov             [rdi], r10
+                mov             rax, r9
+                lea             rsi, [rsi + 8]
+                lea             rdi, [rdi + 8]
+                lea             rcx, [rcx - 1]
+                jmp             .single
+
+.quads:
+                mov             rcx, r8
+.quad:
+                jrcxz           .done
+                mulx            r9, r10, [rsi]
+                adcx            r10, rax
+                adox            r10, [rdi]
+                mov             [rdi], r10
+                mulx            rax, r10, [rsi + 8]
+                adcx            r10, r9
+                adox            r10, [rdi + 8]
+                mov             [rdi + 8], r10
+                mulx            r9, r10, [rsi + 16]
+                adcx            r10, rax
+                adox            r10, [rdi + 16]
+                mov             [rdi + 16], r10
+                mulx            rax, r10, [rsi + 24]
+                adcx            r10, r9
+                adox            r10, [rdi + 24]
+                mov             [rdi + 24], r10
+                lea             rsi, [rsi + 32]
+                lea             rdi, [rdi + 32]
+                lea             rcx, [rcx - 1]
+                jmp             .quad
+
+.done:
+                ; both carries end up in the highest qword, which cannot overflow
+                adcx            rax, r11
+                adox            rax, r11
+                ret
+
+; divides long number by a short
+;    rdi -- address of quotient (long number)
+;    rsi -- address of dividend (long number)
+;    rdx -- length of long numbers in qwords
+;    rcx -- divisor (64-bit unsigned, non-zero)
+; result:
+;    rax -- remainder
+asm_div_long_short:
+                mov             r8, rdx
+                xor             edx, edx
+                test            r8, r8
+                jz              .done
+.loop:
+                mov             rax, [rsi + r8 * 8 - 8]
+                div             rcx
+                mov             [rdi + r8 * 8 - 8], rax
+                dec             r8
+                jnz             .loop
+
+.done:
+                mov             rax, rdx
+                ret
+
+; checks instruction set extensions used by the kernels
+; result:
+;    rax -- bit 0 is set if BMI2 is supported, bit 1 -- if ADX is supported
+asm_cpu_features:
+                push            rbx
+
+                xor             eax, eax
+                cpuid
+                cmp             eax, 7
+                jb              .none
+                mov             eax, 7
+                xor             ecx, ecx
+                cpuid
+                mov             eax, ebx
+                shr             eax, 8          ; BMI2 -- bit 8 of ebx
+                and             eax, 1
+                shr             ebx, 18         ; ADX -- bit 19 of ebx
+                and             ebx, 2
+                or              eax, ebx
+                jmp             .done
+.none:
+                xor             eax, eax
+
+.done:
+                pop             rbx
+                ret
+
+; first calls of the dispatched kernels select implementations and go on with them
+mul_long_short_resolve:
+                call            select_kernels
+                jmp             [rel mul_long_short_impl]
+
+add_long_mul_long_short_resolve:
+                call            select_kernels
+                jmp             [rel add_long_mul_long_short_impl]
+
+; fills the table of dispatched kernels, concurrent calls store the same values
+; modifies:
+;    none of the argument registers
+select_kernels:
+                push            rax
+                push            rcx
+                push            rdx
+                push            r8
+
+                call            asm_cpu_features
+                mov             r8, rax
+
+                lea             rax, [rel asm_mul_long_short_mul]
+                lea             rcx, [rel asm_mul_long_short_mulx]
+                test            r8, 1
+                cmovnz          rax, rcx
+                mov             [rel mul_long_short_impl], rax
+
+                lea             rax, [rel asm_add_long_mul_long_short_mul]
+                lea             rcx, [rel asm_add_long_mul_long_short_adx]
+                and             r8, 3
+                cmp             r8, 3
+                cmove           rax, rcx
+                mov             [rel add_long_mul_long_short_impl], rax
+
+                pop             r8
+                pop             rdx
+                pop             rcx
+                pop             rax
+                ret
+
+
+                section         .data
+mul_long_short_impl:            dq      mul_long_short_resolve
+add_long_mul_long_short_impl:   dq      add_long_mul_long_short_resolve
+
+                section         .note.GNU-stack noalloc noexec nowrite progbits
@@ -0,0 +1,52 @@
+/* Long arithmetic kernels of limbs.asm (x86-64, System V ABI) */
+
+#ifndef LIMBS_H
+#define LIMBS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /***
+   * Long numbers are arrays of qwords (lowest first) with explicit length,
+   * result may coincide with an operand if it starts at the same qword.
+   ***/
+
+  // res[0..n) = a[0..n) + b[0..n), returns carry
+  uint64_t asm_add_long_long(uint64_t *res, const uint64_t *a, const uint64_t *b, size_t n);
+
+  // res[0..n) = a[0..n) - b[0..n), returns borrow
+  uint64_t asm_sub_long_long(uint64_t *res, const uint64_t *a, const uint64_t *b, size_t n);
+
+  // res[0..n) = a[0..n) * b, returns high qword
+  uint64_t asm_mul_long_short(uint64_t *res, const uint64_t *a, size_t n, uint64_t b);
+
+  // res[0..n) += a[0..n) * b, returns high qword
+  uint64_t asm_add_long_mul_long_short(uint64_t *res, const uint64_t *a, size_t n, uint64_t b);
+
+  // q[0..n) = a[0..n) / d, d != 0, returns remainder
+  uint64_t asm_div_long_short(uint64_t *q, const uint64_t *a, size_t n, uint64_t d);
+
+  /* Implementations behind the CPUID dispatch of asm_mul_long_short and asm_add_long_mul_long_short */
+  uint64_t asm_mul_long_short_mul(uint64_t *res, const uint64_t *a, size_t n, uint64_t b);
+  uint64_t asm_mul_long_short_mulx(uint64_t *res, const uint64_t *a, size_t n, uint64_t b); // BMI2
+  uint64_t asm_add_long_mul_long_short_mul(uint64_t *res, const uint64_t *a, size_t n, uint64_t b);
+  uint64_t asm_add_long_mul_long_short_adx(uint64_t *res, const uint64_t *a, size_t n, uint64_t b); // BMI2, ADX
+
+  // bit 0 -- BMI2, bit 1 -- ADX is supported
+  enum
+  {
+    ASM_CPU_BMI2 = 1,
+    ASM_CPU_ADX = 2
+  };
+  uint64_t asm_cpu_features(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LIMBS_H
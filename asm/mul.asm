@@ -1,9 +1,28 @@
-LONG_QWORDS_LENGTH equ          256
+; LONG_QWORDS_LENGTH and KARATSUBA_THRESHOLD can be overridden at assembly time, e.g. nasm -DLONG_QWORDS_LENGTH=4096
+%ifndef LONG_QWORDS_LENGTH
+%define LONG_QWORDS_LENGTH 256
+%endif
+; operands of at least KARATSUBA_THRESHOLD qwords are multiplied by Karatsuba's method
+%ifndef KARATSUBA_THRESHOLD
+%define KARATSUBA_THRESHOLD 32
+%endif
+%if KARATSUBA_THRESHOLD < 4
+%error "KARATSUBA_THRESHOLD must be at least 4"
+%endif
+; scratch space of mul_long_long, enough for any operands of LONG_QWORDS_LENGTH qwords
+MUL_SCRATCH_LENGTH equ          6 * LONG_QWORDS_LENGTH + 256
+; decimal digits are converted by DECIMAL_CHUNK_DIGITS at once, DECIMAL_CHUNK == 10^DECIMAL_CHUNK_DIGITS < 2^64
+DECIMAL_CHUNK   equ             10000000000000000000
+DECIMAL_CHUNK_DIGITS equ        19
                 section         .text
                 global          _start
+                extern          read_char
+                extern          write_char
+                extern          print_string
+                extern          exit
 _start:
 
-                sub             rsp, 3 * LONG_QWORDS_LENGTH * 8
+                sub             rsp, (4 * LONG_QWORDS_LENGTH + MUL_SCRATCH_LENGTH) * 8
                 lea             rdi, [rsp + LONG_QWORDS_LENGTH * 8]
                 mov             rcx, LONG_QWORDS_LENGTH
                 call            read_long
@@ -12,7 +31,9 @@ _start:
 
                 lea             rsi, [rsp + LONG_QWORDS_LENGTH * 8]
                 lea             rdx, [rsp + 2 * LONG_QWORDS_LENGTH * 8]
+                lea             r8, [rsp + 4 * LONG_QWORDS_LENGTH * 8]
                 call            mul_long_long
+                ; lower LONG_QWORDS_LENGTH qwords of the product are printed
                 lea             rdi, [rsp + 2 * LONG_QWORDS_LENGTH * 8]
                 call            write_long
                 call            write_new_line
@@ -77,51 +98,16 @@ mul_long_short:
                 pop             rax
                 ret
 
-; qword-wise left-shifts by 1 long number
-;    rdi -- address of multiplier #1 (long number)
-;    rcx -- length of long number in qwords
-; modifies:
-;    none
-; result:
-;    shifted number is written to rdi
-left_shift_long:
-                push            rax
-                push            rdi
-                push            rsi
-                push            rcx
-
-                lea             rsi, [rdi + rcx * 8 - 16]
-                lea             rdi, [rsi + 8]
-                sub             rcx, 1
-.loop:
-                test            rcx, rcx
-                jz              .end
-                mov             rax, [rsi]
-                mov             [rdi], rax
-                sub             rsi, 8
-                sub             rdi, 8
-                dec             rcx
-                jmp             .loop
-
-.end:
-                xor             rax, rax
-                mov             [rdi], rax
-
-                pop             rcx
-                pop             rsi
-                pop             rdi
-                pop             rax
-                ret
-
 ; multiplies long number by a 64-bit unsigned and adds result to another long
 ;    rdi -- address of multiplier #1 (long number)
 ;    rcx -- length of long number in qwords
 ;    rbx -- multiplier #2 (64-bit unsigned)
 ;    rdx -- address of summand #2 and result (long number)
 ; modifies:
-;    r9
+;    none
 ; result:
 ;    product is added to long at rdx
+;    r9 -- carry out of the highest qword
 add_long_mul_long_short:
                 push            rax
                 push            rdi
@@ -164,37 +150,451 @@ add_long_mul_long_short:
 ; multiplies two long numbers
 ;    rdi -- address of multiplier #1 (long number)
 ;    rsi -- address of multiplier #2 (long number)
-;    rdx -- address of result (long number)
+;    rdx -- address of result (long number of 2 * rcx qwords)
 ;    rcx -- length of long numbers in qwords
+;    r8 -- address of scratch space (MUL_SCRATCH_LENGTH qwords)
 ; modifies:
-;    rbx, r8, r9
+;    rbx, r9
 ; result:
 ;    product is written to rdx
 mul_long_long:
                 push            rax
+                push            rdi
                 push            rsi
                 push            rcx
+                push            r10
 
                 push            rdi
+                push            rcx
                 mov             rdi, rdx
+                shl             rcx, 1
                 call            set_zero
+                pop             rcx
+                pop             rdi
+
+                ; leading zero qwords of multipliers are skipped
+                call            normalized_length
+                test            rax, rax
+                jz              .done
+                mov             r10, rax
+                xchg            rdi, rsi
+                call            normalized_length
+                test            rax, rax
+                jz              .done
+                mov             rcx, rax
+                call            mul_normalized
+
+.done:
+                pop             r10
+                pop             rcx
+                pop             rsi
+                pop             rdi
+                pop             rax
+                ret
+
+; multiplies two long numbers of arbitrary nonzero lengths
+;    rdi -- address of multiplier #1 (long number)
+;    rcx -- length of multiplier #1 in qwords
+;    rsi -- address of multiplier #2 (long number)
+;    r10 -- length of multiplier #2 in qwords
+;    rdx -- address of result (long number of rcx + r10 qwords)
+;    r8 -- address of scratch space
+; modifies:
+;    rbx, r9
+; result:
+;    product is written to rdx
+mul_normalized:
+                push            rdi
+                push            rsi
+                push            rdx
+                push            rcx
+                push            r8
+                push            r10
+                push            r11
+                push            r12
+                push            r13
+
+                ; multiplier #2 is made the shorter one
+                cmp             rcx, r10
+                jae             .ordered
+                xchg            rdi, rsi
+                xchg            rcx, r10
+.ordered:
+                cmp             r10, KARATSUBA_THRESHOLD
+                jae             .split
+                call            mul_basecase
+                jmp             .done
+
+.split:
+                ; multiplier #1 is cut into pieces of r10 qwords,
+                ; product of each piece by multiplier #2 is computed in scratch and added at its offset
+                push            rdi
+                push            rcx
+                mov             rdi, rdx
+                add             rcx, r10
+                call            set_zero
+                pop             rcx
+                pop             rdi
+
+                mov             r11, rcx        ; r11 -- qwords of multiplier #1 left
+                mov             r12, rdx        ; r12 -- result at the offset of the piece
+                mov             r13, r8         ; r13 -- product of the piece
+.piece:
+                cmp             r11, r10
+                jb              .tail
+                mov             rcx, r10
+                mov             rdx, r13
+                lea             r8, [r13 + r10 * 8]
+                lea             r8, [r8 + r10 * 8]
+                call            mul_karatsuba
+
+                push            rdi
+                push            rsi
+                mov             rdi, r12
+                lea             rcx, [r11 + r10]
+                mov             rsi, r13
+                lea             rdx, [r10 + r10]
+                call            add_long_long_wide
+                pop             rsi
+                pop             rdi
+
+                lea             rdi, [rdi + r10 * 8]
+                lea             r12, [r12 + r10 * 8]
+                sub             r11, r10
+                jmp             .piece
+
+.tail:
+                test            r11, r11
+                jz              .done
+                ; the rest of multiplier #1 is shorter than multiplier #2
+                mov             rcx, r11
+                mov             rdx, r13
+                lea             r8, [r13 + r11 * 8]
+                lea             r8, [r8 + r10 * 8]
+                call            mul_normalized
+
+                mov             rdi, r12
+                lea             rcx, [r11 + r10]
+                mov             rsi, r13
+                mov             rdx, rcx
+                call            add_long_long_wide
+
+.done:
+                pop             r13
+                pop             r12
+                pop             r11
+                pop             r10
+                pop             r8
+                pop             rcx
+                pop             rdx
+                pop             rsi
+                pop             rdi
+                ret
+
+; multiplies two long numbers of equal length by Karatsuba's method:
+; a * b == z2 * B^2h + (z1 - z2 - z0) * B^h + z0, where
+; z0 == a0 * b0, z2 == a1 * b1, z1 == (a0 + a1) * (b0 + b1), a == a1 * B^h + a0, b == b1 * B^h + b0
+;    rdi -- address of multiplier #1 (long number)
+;    rsi -- address of multiplier #2 (long number)
+;    rcx -- length of long numbers in qwords
+;    rdx -- address of result (long number of 2 * rcx qwords)
+;    r8 -- address of scratch space
+; modifies:
+;    rbx, r9
+; result:
+;    product is written to rdx
+mul_karatsuba:
+                cmp             rcx, KARATSUBA_THRESHOLD
+                jae             .split
+                push            r10
+                mov             r10, rcx
+                call            mul_basecase
+                pop             r10
+                ret
+
+.split:
+                push            rdi
+                push            rsi
+                push            rdx
+                push            rcx
+                push            r8
+                push            r10
+                push            r11
+                push            r12
+                push            r13
+                push            r14
+                push            r15
+
+                mov             r11, rcx
+                shr             r11, 1          ; r11 -- h, length of low halves
+                mov             r12, rcx
+                sub             r12, r11        ; r12 -- m, length of high halves, m == h or m == h + 1
+                mov             r13, rdi
+                mov             r14, rsi
+                mov             r15, rdx
+
+                ; z0 -> result[0, 2h)
+                mov             rcx, r11
+                call            mul_karatsuba
+                ; z2 -> result[2h, 2n)
+                lea             rdi, [r13 + r11 * 8]
+                lea             rsi, [r14 + r11 * 8]
+                lea             rdx, [r15 + r11 * 8]
+                lea             rdx, [rdx + r11 * 8]
+                mov             rcx, r12
+                call            mul_karatsuba
+
+                ; a0 + a1 -> scratch[0, m + 1), b0 + b1 -> scratch[m + 1, 2m + 2)
+                mov             rdi, r13
+                lea             rsi, [r13 + r11 * 8]
+                mov             rcx, r11
+                mov             r10, r12
+                mov             rbx, r8
+                call            add_halves
+                mov             rdi, r14
+                lea             rsi, [r14 + r11 * 8]
+                lea             rbx, [r8 + r12 * 8 + 8]
+                call            add_halves
+
+                ; z1 -> scratch[2m + 2, 4m + 4), the rest of scratch is left to the recursive call
+                mov             rdi, r8
+                lea             rsi, [r8 + r12 * 8 + 8]
+                lea             rdx, [rsi + r12 * 8 + 8]
+                lea             rcx, [r12 + 1]
+                lea             r8, [rdx + rcx * 8]
+                lea             r8, [r8 + rcx * 8]
+                call            mul_karatsuba
+
+                ; z1 - z0 - z2 >= 0
+                mov             rdi, rdx
+                lea             rcx, [r12 + r12 + 2]
+                mov             rsi, r15
+                lea             rdx, [r11 + r11]
+                call            sub_long_long_wide
+                lea             rsi, [r15 + r11 * 8]
+                lea             rsi, [rsi + r11 * 8]
+                lea             rdx, [r12 + r12]
+                call            sub_long_long_wide
+
+                ; result[h, 2n) += z1 - z0 - z2, 2m + 2 <= 2n - h as h >= 2
+                mov             rsi, rdi
+                mov             rdx, rcx
+                lea             rdi, [r15 + r11 * 8]
+                lea             rcx, [r11 + r12 * 2]
+                call            add_long_long_wide
+
+                pop             r15
+                pop             r14
+                pop             r13
+                pop             r12
+                pop             r11
+                pop             r10
+                pop             r8
+                pop             rcx
+                pop             rdx
+                pop             rsi
+                pop             rdi
+                ret
+
+; multiplies two long numbers row by row
+;    rdi -- address of multiplier #1 (long number)
+;    rcx -- length of multiplier #1 in qwords
+;    rsi -- address of multiplier #2 (long number)
+;    r10 -- length of multiplier #2 in qwords
+;    rdx -- address of result (long number of rcx + r10 qwords)
+; modifies:
+;    rbx, r9
+; result:
+;    product is written to rdx
+mul_basecase:
+                push            rsi
+                push            rdx
+                push            r10
+
+                push            rdi
+                push            rcx
+                mov             rdi, rdx
+                add             rcx, r10
+                call            set_zero
+                pop             rcx
                 pop             rdi
-                mov             rax, rcx
-                mov             r8, 1
 
 .loop:
                 mov             rbx, [rsi]
+                test            rbx, rbx
+                jz              .next
                 call            add_long_mul_long_short
-                call            left_shift_long
+                ; no row has reached this qword yet, so the carry is just stored
+                mov             [rdx + rcx * 8], r9
+.next:
                 add             rsi, 8
-                dec             rax
+                add             rdx, 8
+                dec             r10
                 jnz             .loop
 
+                pop             r10
+                pop             rdx
+                pop             rsi
+                ret
+
+; adds low and high halves of a long number
+;    rdi -- address of low half (long number)
+;    rcx -- length of low half in qwords
+;    rsi -- address of high half (long number)
+;    r10 -- length of high half in qwords, r10 >= rcx > 0
+;    rbx -- address of result (long number of r10 + 1 qwords)
+; modifies:
+;    none
+; result:
+;    sum is written to rbx
+add_halves:
+                push            rax
+                push            rdi
+                push            rsi
+                push            rcx
+                push            rbx
+                push            rdx
+
+                mov             rdx, r10
+                sub             rdx, rcx
+                ; lea, mov, dec and jrcxz keep the carry flag
+                clc
+.low:
+                mov             rax, [rsi]
+                adc             rax, [rdi]
+                mov             [rbx], rax
+                lea             rdi, [rdi + 8]
+                lea             rsi, [rsi + 8]
+                lea             rbx, [rbx + 8]
+                dec             rcx
+                jnz             .low
+
+                mov             rcx, rdx
+                jrcxz           .top
+.high:
+                mov             rax, [rsi]
+                adc             rax, 0
+                mov             [rbx], rax
+                lea             rsi, [rsi + 8]
+                lea             rbx, [rbx + 8]
+                dec             rcx
+                jnz             .high
+
+.top:
+                mov             rax, 0
+                adc             rax, 0
+                mov             [rbx], rax
+
+                pop             rdx
+                pop             rbx
                 pop             rcx
                 pop             rsi
+                pop             rdi
                 pop             rax
                 ret
 
+; adds long number to a longer one
+;    rdi -- address of summand #1 (long number)
+;    rcx -- length of summand #1 in qwords
+;    rsi -- address of summand #2 (long number)
+;    rdx -- length of summand #2 in qwords, rcx >= rdx > 0
+; modifies:
+;    none
+; result:
+;    sum is written to rdi, carry out of the highest qword is lost
+add_long_long_wide:
+                push            rax
+                push            rdi
+                push            rsi
+                push            rcx
+                push            rdx
+
+                sub             rcx, rdx
+                clc
+.loop:
+                mov             rax, [rsi]
+                adc             [rdi], rax
+                lea             rsi, [rsi + 8]
+                lea             rdi, [rdi + 8]
+                dec             rdx
+                jnz             .loop
+
+.carry:
+                jnc             .done
+                jrcxz           .done
+                adc             qword [rdi], 0
+                lea             rdi, [rdi + 8]
+                dec             rcx
+                jmp             .carry
+
+.done:
+                pop             rdx
+                pop             rcx
+                pop             rsi
+                pop             rdi
+                pop             rax
+                ret
+
+; subtracts long number from a longer one
+;    rdi -- address of minuend (long number)
+;    rcx -- length of minuend in qwords
+;    rsi -- address of subtrahend (long number)
+;    rdx -- length of subtrahend in qwords, rcx >= rdx > 0
+; modifies:
+;    none
+; result:
+;    difference is written to rdi, borrow out of the highest qword is lost
+sub_long_long_wide:
+                push            rax
+                push            rdi
+                push            rsi
+                push            rcx
+                push            rdx
+
+                sub             rcx, rdx
+                clc
+.loop:
+                mov             rax, [rsi]
+                sbb             [rdi], rax
+                lea             rsi, [rsi + 8]
+                lea             rdi, [rdi + 8]
+                dec             rdx
+                jnz             .loop
+
+.borrow:
+                jnc             .done
+                jrcxz           .done
+                sbb             qword [rdi], 0
+                lea             rdi, [rdi + 8]
+                dec             rcx
+                jmp             .borrow
+
+.done:
+                pop             rdx
+                pop             rcx
+                pop             rsi
+                pop             rdi
+                pop             rax
+                ret
+
+; computes length of long number without leading zero qwords
+;    rdi -- argument (long number)
+;    rcx -- length of long number in qwords
+; modifies:
+;    none
+; result:
+;    rax -- length without leading zero qwords, 0 for zero
+normalized_length:
+                mov             rax, rcx
+.loop:
+                test            rax, rax
+                jz              .done
+                cmp             qword [rdi + rax * 8 - 8], 0
+                jne             .done
+                dec             rax
+                jmp             .loop
+.done:
+                ret
 
 ; divides long number by a short
 ;    rdi -- address of dividend (long number)
@@ -244,36 +644,23 @@ set_zero:
                 pop             rax
                 ret
 
-; checks if a long number is a zero
-;    rdi -- argument (long number)
-;    rcx -- length of long number in qwords
-; modifies:
-;    none
-; result:
-;    ZF=1 if zero
-is_zero:
-                push            rax
-                push            rdi
-                push            rcx
-
-                xor             rax, rax
-                repe scasq
-
-                pop             rcx
-                pop             rdi
-                pop             rax
-                ret
-
 ; read long number from stdin
 ;    rdi -- location for output (long number)
 ;    rcx -- length of long number in qwords
 ; modifies:
-;    rax, rbx, rsi (if no invalid characters are read)
+;    rax, rbx, rdx, rsi, r8, r9 (if no invalid characters are read)
 read_long:
                 push            rcx
                 push            rdi
 
                 call            set_zero
+                ; only the used qwords are multiplied, r9 -- length of long number
+                mov             r9, rcx
+                xor             rcx, rcx
+                ; digits are gathered into r8, rbx == 10^(number of gathered digits)
+.chunk:
+                xor             r8, r8
+                mov             rbx, 1
 .loop:
                 call            read_char
                 or              rax, rax
@@ -286,12 +673,35 @@ read_long:
                 ja              .invalid_char
 
                 sub             rax, '0'
-                mov             rbx, 10
+                imul            r8, r8, 10
+                add             r8, rax
+                imul            rbx, rbx, 10
+                mov             rax, DECIMAL_CHUNK
+                cmp             rbx, rax
+                jne             .loop
+                mov             rax, r8
+                xor             r8, r8          ; r8 == 0 -- more chunks follow
+                jmp             .append
+
+.done:
+                mov             rax, r8
+                mov             r8, 1
+
+.append:
+                ; the result takes at most one qword more than is used now
+                cmp             rcx, r9
+                je              .full
+                inc             rcx
+.full:
                 call            mul_long_short
                 call            add_long_short
-                jmp             .loop
+                cmp             qword [rdi + rcx * 8 - 8], 0
+                jne             .used
+                dec             rcx
+.used:
+                test            r8, r8
+                jz              .chunk
 
-.done:
                 pop             rdi
                 pop             rcx
                 ret
@@ -316,7 +726,7 @@ read_long:
 ;    rdi -- argument (long number)
 ;    rcx -- length of long number in qwords
 ; modifies:
-;    rbx, rbp
+;    rbx, rbp, r8
 ; result:
 ;    at rdi -- 0
 write_long:
@@ -332,15 +742,44 @@ write_long:
 
                 mov             rsi, rbp
 
+                ; only the significant qwords are divided, at least one
+                call            normalized_length
+                mov             rcx, rax
+                test            rcx, rcx
+                jnz             .loop
+                inc             rcx
+
 .loop:
-                mov             rbx, 10
+                mov             rbx, DECIMAL_CHUNK
                 call            div_long_short
-                add             rdx, '0'
+                ; the remainder gives DECIMAL_CHUNK_DIGITS digits
+                mov             rax, rdx
+                mov             rbx, 10
+                mov             r8, DECIMAL_CHUNK_DIGITS
+.digit:
+                xor             rdx, rdx
+                div             rbx
+                add             dl, '0'
                 dec             rsi
                 mov             [rsi], dl
-                call            is_zero
+                dec             r8
+                jnz             .digit
+                cmp             qword [rdi + rcx * 8 - 8], 0
+                jne             .loop
+                dec             rcx
                 jnz             .loop
 
+                ; leading zeros of the highest chunk are skipped, at least one digit is left
+                lea             rax, [rbp - 1]
+.skip_zero:
+                cmp             rsi, rax
+                je              .print
+                cmp             byte [rsi], '0'
+                jne             .print
+                inc             rsi
+                jmp             .skip_zero
+
+.print:
                 mov             rdx, rbp
                 sub             rdx, rsi
                 call            print_string
@@ -369,81 +808,6 @@ write_new_line:
                 pop             rcx
                 ret
 
-; read one char from stdin
-; modifies:
-;    rax, rsi
-; result:
-;    rax == -1 if error occurs
-;    rax \in [0; 255] if OK
-read_char:
-                push            rcx
-                push            rdi
-
-                sub             rsp, 1
-                xor             rax, rax
-                xor             rdi, rdi
-                mov             rsi, rsp
-                mov             rdx, 1
-                syscall
-
-                cmp             rax, 1
-                jne             .error
-                xor             rax, rax
-                mov             al, [rsp]
-                add             rsp, 1
-
-                pop             rdi
-                pop             rcx
-                ret
-.error:
-                mov             rax, -1
-                add             rsp, 1
-                pop             rdi
-                pop             rcx
-                ret
-
-; write one char to stdout, errors are ignored
-; modifies:
-;    rax, rcx, rdi, rsi
-; result:
-;    al -- char
-write_char:
-                sub             rsp, 1
-                mov             [rsp], al
-
-                mov             rax, 1
-                mov             rdi, 1
-                mov             rsi, rsp
-                mov             rdx, 1
-                syscall
-                add             rsp, 1
-                ret
-
-exit:
-                mov             rax, 60
-                xor             rdi, rdi
-                syscall
-
-; print string to stdout
-;    rsi -- string
-;    rdx -- size
-; modifies:
-;    none
-print_string:
-                push            rax
-                push            rcx
-                push            rdi
-
-                mov             rax, 1
-                mov             rdi, 1
-                syscall
-
-                pop             rdi
-                pop             rcx
-                pop             rax
-                ret
-
-
                 section         .rodata
 invalid_char_msg:
                 db              "Invalid character: "
@@ -1,6 +1,13 @@
 LONG_QWORDS_LENGTH equ          128
+; decimal digits are converted by DECIMAL_CHUNK_DIGITS at once, DECIMAL_CHUNK == 10^DECIMAL_CHUNK_DIGITS < 2^64
+DECIMAL_CHUNK   equ             10000000000000000000
+DECIMAL_CHUNK_DIGITS equ        19
                 section         .text
                 global          _start
+                extern          read_char
+                extern          write_char
+                extern          print_string
+                extern          exit
 _start:
 
                 sub             rsp, 2 * LONG_QWORDS_LENGTH * 8
@@ -176,12 +183,16 @@ is_zero:
 ;    rdi -- location for output (long number)
 ;    rcx -- length of long number in qwords
 ; modifies:
-;    rax, rbx, rsi (if no invalid characters are read)
+;    rax, rbx, rdx, rsi, r8 (if no invalid characters are read)
 read_long:
                 push            rcx
                 push            rdi
 
                 call            set_zero
+                ; digits are gathered into r8, rbx == 10^(number of gathered digits)
+.chunk:
+                xor             r8, r8
+                mov             rbx, 1
 .loop:
                 call            read_char
                 or              rax, rax
@@ -194,12 +205,23 @@ read_long:
                 ja              .invalid_char
 
                 sub             rax, '0'
-                mov             rbx, 10
+                imul            r8, r8, 10
+                add             r8, rax
+                imul            rbx, rbx, 10
+                mov             rax, DECIMAL_CHUNK
+                cmp             rbx, rax
+                jne             .loop
+
+                mov             rax, r8
                 call            mul_long_short
                 call            add_long_short
-                jmp             .loop
+                jmp             .chunk
 
 .done:
+                mov             rax, r8
+                call            mul_long_short
+                call            add_long_short
+
                 pop             rdi
                 pop             rcx
                 ret
@@ -224,7 +246,7 @@ read_long:
 ;    rdi -- argument (long number)
 ;    rcx -- length of long number in qwords
 ; modifies:
-;    rbx, rbp
+;    rbx, rbp, r8
 ; result:
 ;    at rdi -- 0
 write_long:
@@ -241,14 +263,34 @@ write_long:
                 mov             rsi, rbp
 
 .loop:
-                mov             rbx, 10
+                mov             rbx, DECIMAL_CHUNK
                 call            div_long_short
-                add             rdx, '0'
+                ; the remainder gives DECIMAL_CHUNK_DIGITS digits
+                mov             rax, rdx
+                mov             rbx, 10
+                mov             r8, DECIMAL_CHUNK_DIGITS
+.digit:
+                xor             rdx, rdx
+                div             rbx
+                add             dl, '0'
                 dec             rsi
                 mov             [rsi], dl
+                dec             r8
+                jnz             .digit
                 call            is_zero
                 jnz             .loop
 
+                ; leading zeros of the highest chunk are skipped, at least one digit is left
+                lea             rax, [rbp - 1]
+.skip_zero:
+                cmp             rsi, rax
+                je              .print
+                cmp             byte [rsi], '0'
+                jne             .print
+                inc             rsi
+                jmp             .skip_zero
+
+.print:
                 mov             rdx, rbp
                 sub             rdx, rsi
                 call            print_string
@@ -277,81 +319,6 @@ write_new_line:
                 pop             rcx
                 ret
 
-; read one char from stdin
-; modifies:
-;    rax, rsi
-; result:
-;    rax == -1 if error occurs
-;    rax \in [0; 255] if OK
-read_char:
-                push            rcx
-                push            rdi
-
-                sub             rsp, 1
-                xor             rax, rax
-                xor             rdi, rdi
-                mov             rsi, rsp
-                mov             rdx, 1
-                syscall
-
-                cmp             rax, 1
-                jne             .error
-                xor             rax, rax
-                mov             al, [rsp]
-                add             rsp, 1
-
-                pop             rdi
-                pop             rcx
-                ret
-.error:
-                mov             rax, -1
-                add             rsp, 1
-                pop             rdi
-                pop             rcx
-                ret
-
-; write one char to stdout, errors are ignored
-; modifies:
-;    rax, rcx, rdi, rsi
-; result:
-;    al -- char
-write_char:
-                sub             rsp, 1
-                mov             [rsp], al
-
-                mov             rax, 1
-                mov             rdi, 1
-                mov             rsi, rsp
-                mov             rdx, 1
-                syscall
-                add             rsp, 1
-                ret
-
-exit:
-                mov             rax, 60
-                xor             rdi, rdi
-                syscall
-
-; print string to stdout
-;    rsi -- string
-;    rdx -- size
-; modifies:
-;    none
-print_string:
-                push            rax
-                push            rcx
-                push            rdi
-
-                mov             rax, 1
-                mov             rdi, 1
-                syscall
-
-                pop             rdi
-                pop             rcx
-                pop             rax
-                ret
-
-
                 section         .rodata
 invalid_char_msg:
                 db              "Invalid character: "
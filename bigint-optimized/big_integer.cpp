@@ -3,10 +3,20 @@
 #include <cstring>
 #include <stdexcept>
 #include <algorithm>
+#include <functional>
 #include <iostream>
 #include <sstream>
+#include <cmath>
 
 #include "big_integer.h"
+#include "multiplication.h"
+#include "division.h"
+#include "conversion.h"
+#include "modular.h"
+#include "gcd.h"
+#include "instrumentation.h"
+
+namespace instrumentation = big_int_util::instrumentation;
 
 /* Basis for big integer functions */
 template<typename type>
@@ -22,20 +32,18 @@ big_integer::place_t big_integer::default_place() const
   return ::default_place<place_t>(sign_bit());
 }
 
-big_integer::place_t big_integer::get_or_default(int64_t at) const
-{
-  if (at < 0) return 0;
-  if (static_cast<size_t>(at) >= data.size()) return default_place();
-  return data[at];
-}
-
 big_integer & big_integer::shrink()
 {
   // make sure invariant holds
-  while (data.size() > 1 && data.back() == default_place() &&
-         sign_bit() == ::sign_bit(data[data.size() - 2]))
+  const storage_t &d = data;
+  const place_t *places = d.data();
+  place_t def = default_place();
+  size_t n = d.size();
+  while (n > 1 && places[n - 1] == def && ::sign_bit(def) == ::sign_bit(places[n - 2]))
     // while last place is default and no change in sign
-    data.pop_back();
+    n--;
+  instrumentation::count_shrink(d.size() - n);
+  data.resize(n);
   return *this;
 }
 
@@ -47,6 +55,13 @@ size_t big_integer::unsigned_size() const
   return std::max(size_t{1}, data.size() - (data.back() == default_place()));
 }
 
+size_t big_integer::bit_length() const
+{
+  const storage_t &d = data;
+  size_t n = unsigned_size();
+  return d[n - 1] == 0 ? 0 : n * PLACE_BITS - big_int_util::leading_zeros(d[n - 1]);
+}
+
 big_integer & big_integer::correct_sign_bit(bool expected_sign_bit, place_t carry)
 {
   // invariant does not hold for now
@@ -54,10 +69,16 @@ big_integer & big_integer::correct_sign_bit(bool expected_sign_bit, place_t carr
   try
   {
     if (carry != 0)
+    {
       data.push_back(carry);
+      instrumentation::count_sign_place();
+    }
     if (sign_bit() != expected_sign_bit && !(expected_sign_bit &&
       std::all_of(data.begin(), data.end(), [](place_t i) { return i == 0; })))
+    {
       data.push_back(::default_place<place_t>(expected_sign_bit));
+      instrumentation::count_sign_place();
+    }
   }
   catch (...)
   {
@@ -72,7 +93,7 @@ big_integer & big_integer::revert_sign(bool sign)
 {
   // if *this == 0 nothing changes
   if (sign_bit() != sign)
-    *this = - *this;
+    negate();
   return *this;
 }
 
@@ -83,48 +104,37 @@ bool big_integer::make_absolute()
   return sign;
 }
 
-void big_integer::iterate(const big_integer &b, const binary_operator &action)
-{
-  resize(std::max(data.size(), b.data.size()));
-  auto l_end = data.end();
-  auto r_end = b.data.end(), r_it = b.data.begin();
-  for (auto it = data.begin(); it != l_end; it++)
+template<typename binary_operator>
+  void big_integer::iterate(const big_integer &b, binary_operator action)
   {
-    *it = action(*it, r_it >= r_end ? b.default_place() : *r_it);
-    if (r_it != r_end) r_it++;
+    size_t n = data.size(), m = b.data.size();
+    place_t r_default = b.default_place();
+    resize(std::max(n, m));
+    // b may alias *this, so its places are taken after data is made unique
+    place_t *l = data.data();
+    const place_t *r = b.data.data();
+    // plain loops over places, so that simple actions get vectorized,
+    // shorter b is extended by its default place (*this is already by resize)
+    for (size_t i = 0; i < m; i++)
+      l[i] = action(l[i], r[i]);
+    for (size_t i = m; i < n; i++)
+      l[i] = action(l[i], r_default);
   }
-}
-void big_integer::iterate(const unary_operator &action)
-{
-  auto end = data.end();
-  for (auto it = data.begin(); it != end; it++)
-    *it = action(*it);
-}
-void big_integer::iterate_r(const unary_operator &action)
-{
-  auto begin = data.begin();
-  for (auto it = data.end(); it != begin; it--)
-    *(it - 1) = action(*(it - 1));
-}
-void big_integer::iterate(const unary_consumer &action) const
-{
-  auto end = data.end();
-  for (auto it = data.begin(); it != end; it++)
-    action(*it);
-}
-void big_integer::iterate_r(const unary_consumer &action) const
-{
-  auto begin = data.begin();
-  for (auto it = data.end(); it != begin; it--)
-    action(*(it - 1));
-}
 
-big_integer & big_integer::place_wise(const big_integer &b,
-  const binary_operator &action)
-{
-  iterate(b, action);
-  return shrink();
-}
+template<typename unary_operator>
+  void big_integer::iterate(unary_operator action)
+  {
+    place_t *d = data.data();
+    for (size_t i = 0, n = data.size(); i < n; i++)
+      d[i] = action(d[i]);
+  }
+
+template<typename binary_operator>
+  big_integer & big_integer::place_wise(const big_integer &b, binary_operator action)
+  {
+    iterate(b, action);
+    return shrink();
+  }
 
 /***
  * Major functions for big_integer
@@ -143,354 +153,339 @@ big_integer::big_integer(place_t place) : data(1, place)
   correct_sign_bit(0);
 }
 
-big_integer::big_integer(const std::string &str) : data(1, place_t{0})
+big_integer::big_integer(const std::string &str, int base) : data(1, place_t{0})
 {
-  auto it = str.cbegin();
-  bool is_negated = false;
-  if (it != str.cend() && *it == '-')
-  {
-    is_negated = true;
-    it++;
-  }
-
-  if (it == str.cend())
+  if (!big_int_util::is_valid_base(base))
+    throw std::invalid_argument("big_integer: base must be in [2, 36]");
+  const char *end = str.data() + str.size();
+  from_chars_result res = from_chars(str.data(), end, *this, base);
+  if (res.ec != std::errc() || res.ptr != end)
     throw std::runtime_error("Cannot read number from string: '" + str + "'");
+}
 
-  for (; it != str.cend(); it++)
-  {
-    short_multiply(10);
-    *this += *it - '0';
-  }
-
-  revert_sign(is_negated);
+big_integer::big_integer(place_view places) : data(storage_t::adopt(places.data, places.size))
+{
+  if (data.size() == 0)
+    data.push_back(0);
+  // only the size may change, so the places are still not copied
+  shrink();
 }
 
 big_integer::~big_integer()
 {
 }
 
+big_integer::big_integer(big_integer &&other) noexcept : data(1, place_t{0})
+{
+  data.swap(other.data);
+}
+
 big_integer & big_integer::operator=(const big_integer &other)
 {
   data = other.data;
   return *this;
 }
 
-/***
- * Arithmetic functions for 32/64-bit numbers
- **/
-
-template<typename type>
-  static type addc(type left, type right, bool &carry)
-  {
-    static constexpr auto limit_max = std::numeric_limits<type>::max();
-    bool old_carry = carry;
-    carry = (limit_max - left < right ||
-             (left == limit_max && carry == 1) ||
-             limit_max - left - carry < right);
-    return left + right + old_carry;
-  }
+big_integer & big_integer::operator=(big_integer &&other) noexcept
+{
+  data.swap(other.data);
+  return *this;
+}
 
-static inline uint32_t low_bytes(uint64_t x) { return x & 0xFFFFFFFF; }
-static inline uint32_t high_bytes(uint64_t x) { return x >> 32; }
-static inline uint16_t low_bytes(uint32_t x) { return x & 0xFFFF; }
-static inline uint16_t high_bytes(uint32_t x) { return x >> 16; }
+/***
+ * Rest of arithmetic operators for big_integer
+ ***/
 
-static std::pair<uint64_t, uint64_t> mul(uint64_t left, uint64_t right)
+big_integer & big_integer::add_shifted(const big_integer &rhs, size_t offset, bool subtract)
 {
-  uint64_t left_low = low_bytes(left);
-  uint64_t right_low = low_bytes(right);
-  uint64_t left_high = high_bytes(left);
-  uint64_t right_high = high_bytes(right);
-  uint64_t bd = left_low * right_low;
-  uint64_t ad = left_high * right_low;
-  uint64_t bc = left_low * right_high;
-  uint64_t ac = left_high * right_high;
+  // places of rhs are read while *this is written, so shifted self must be copied
+  if (&rhs == this && offset != 0)
+    return add_shifted(big_integer(rhs), offset, subtract);
 
-  // res = ac * 2^64 + (ad + bc) * 2^32 + bd
+  size_t m = rhs.size(), n = std::max(size(), m + offset) + 1;
+  instrumentation::count_operation(subtract ? instrumentation::op_sub : instrumentation::op_add, n - 1);
+  place_t r_default = rhs.default_place();
+  // one more place, so that result fits into n places of two's complement
+  resize(n);
+  place_t *l = data.data() + offset;
+  const place_t *r = rhs.data.data();
+  size_t rest = n - offset - m;
 
-  uint32_t carry = high_bytes(uint64_t{high_bytes(bd)} + low_bytes(bc) + low_bytes(ad));
-  return
+  // higher places of rhs are all 0 or all 1 (-1 modulo 2^(rest * PLACE_BITS)),
+  // so after the common part only a single place is carried into the rest
+  if (subtract)
   {
-    bd + (ad << 32) + (bc << 32),
-    ac + high_bytes(ad) + high_bytes(bc) + carry
-  };
+    place_t borrow = big_int_util::sub_n(l, l, r, m);
+    if (r_default == 0)
+      big_int_util::sub_1(l + m, l + m, rest, borrow);
+    else
+      big_int_util::add_1(l + m, l + m, rest, 1 - borrow);
+  }
+  else
+  {
+    place_t carry = big_int_util::add_n(l, l, r, m);
+    if (r_default == 0)
+      big_int_util::add_1(l + m, l + m, rest, carry);
+    else
+      big_int_util::sub_1(l + m, l + m, rest, 1 - carry);
+  }
+  return shrink();
 }
 
-static std::pair<uint32_t, uint32_t> mul(uint32_t left, uint32_t right)
+big_integer & big_integer::sub_shifted(const big_integer &rhs, size_t offset)
 {
-  uint64_t res = uint64_t{left} * right;
-  return {low_bytes(res), high_bytes(res)};
+  return add_shifted(rhs, offset, true);
 }
 
-static bool less_3_digits(uint64_t lhs_low, uint32_t lhs_high,
-                          uint64_t rhs_low, uint32_t rhs_high)
+big_integer & big_integer::operator+=(const big_integer &rhs)
 {
-  return lhs_high < rhs_high || (lhs_high == rhs_high && lhs_low < rhs_low);
+  return add_shifted(rhs, 0, false);
 }
 
-static uint64_t get_3_digits(uint64_t low, uint32_t high, int at)
+big_integer & big_integer::operator-=(const big_integer &rhs)
 {
-  switch (at)
-  {
-  case -1:
-    return high;
-  case 0:
-    return (uint64_t{high} << 16) | (low >> 48);
-  case 1:
-    return (uint64_t{low_bytes(high)} << 32) | (low >> 32);
-  }
-  return 0;
+  return sub_shifted(rhs, 0);
 }
 
-static std::pair<uint64_t, uint32_t> sub_5_digits(uint64_t lhs_low, uint32_t lhs_high,
-                                                  uint64_t rhs_low, uint16_t rhs_high, int at)
+big_integer & big_integer::operator*=(const big_integer &rhs)
 {
-  if (at == 0)
+  // rhs may alias *this, so take its sign before making *this absolute
+  instrumentation::count_operation(instrumentation::op_mul, std::max(size(), rhs.size()));
+  place_t factor;
+  if (rhs.short_magnitude(factor))
   {
-    uint64_t l64 = (uint64_t{low_bytes(lhs_high)} << 48)| (lhs_low >> 16);
-    bool borrow = 0;
-    l64 = addc(l64, ~rhs_low + 1, borrow);
-    uint16_t l16 = high_bytes(lhs_high);
-    l16 -= borrow;
-    borrow = 0;
-    l16 = addc(l16, (uint16_t)(~rhs_high + 1), borrow);
-    lhs_high = (uint32_t{l16} << 16) | (uint32_t)(l64 >> 48);
-    lhs_low = (l64 << 16) | low_bytes(lhs_low);
+    // places are multiplied in place: as unsigned ones they are *this + B^n if it is negative,
+    // so factor * B^n is taken back from the high place (the product fits into n + 1 places)
+    bool rhs_sign = rhs.sign_bit(), this_sign = sign_bit();
+    size_t n = size();
+    resize(n + 1);
+    place_t *places = data.data();
+    places[n] = big_int_util::mul_1(places, places, n, factor) - (this_sign ? factor : 0);
+    shrink();
+    return rhs_sign ? negate() : *this;
   }
-  else
+
+  const storage_t &l = data;
+  if (l.data() == rhs.data.data() && size() == rhs.size())
   {
-    bool borrow = 0;
-    lhs_low = addc(lhs_low, ~rhs_low + 1, borrow);
-    lhs_high -= borrow;
-    borrow = 0;
-    lhs_high = addc(lhs_high, (uint32_t)(~rhs_high + 1), borrow);
+    // rhs is *this or shares its places: squaring is faster
+    make_absolute();
+    size_t n = unsigned_size();
+    storage_t res(2 * n + 1, 0);
+    big_int_util::sqr(res.data(), l.data(), n);
+    data.swap(res);
+    return shrink();
   }
-  return {lhs_low, lhs_high};
+
+  bool rhs_sign = rhs.sign_bit();
+  big_integer right = rhs_sign ? -rhs : rhs;
+  bool sign = make_absolute() ^ rhs_sign;
+
+  const storage_t &r = right.data;
+  size_t n = unsigned_size(), m = right.unsigned_size();
+  // one more place for sign bit
+  storage_t res(n + m + 1, 0);
+  big_int_util::mul(res.data(), l.data(), n, r.data(), m);
+  data.swap(res);
+  return shrink().revert_sign(sign);
 }
 
-static std::pair<uint32_t, uint64_t> div3_2(uint32_t lhs_low, uint32_t lhs_med, uint32_t lhs_high,
-                                            uint32_t rhs_low, uint32_t rhs_high)
+// long division of absolute values on places (see division.h)
+big_integer & big_integer::long_divide(const big_integer &rhs, big_integer &rem)
 {
-  // divide in base 2^16 with trial digits on prefixes
-  uint64_t
-    r_low64 = (uint64_t{lhs_med} << 32) | lhs_low,
-    d = (uint64_t{rhs_high} << 32) | rhs_low;
-  uint32_t
-    r_high = lhs_high,
-    d2 = rhs_high;
+  // rhs may alias rem, so take it before rem is changed
+  bool rhs_sign = rhs.sign_bit();
+  big_integer right = rhs_sign ? -rhs : rhs;
+  bool this_sign = make_absolute(), sign = this_sign ^ rhs_sign;
 
-  if (get_3_digits(r_low64, r_high, -1) / d2 != 0)
-    // overflow
-    return {std::numeric_limits<uint32_t>::max(), 0};
+  size_t n = unsigned_size(), m = right.unsigned_size();
 
-  // high trial digit
-  uint16_t qt1 = (uint16_t)(get_3_digits(r_low64, r_high, 0) / d2);
-  auto dq = mul(d, uint64_t{qt1});
-  if (less_3_digits(r_low64, r_high, dq.first << 16, low_bytes((dq.second << 16) | (dq.first >> 48))))
+  if (m > n)
   {
-    // correct estimate
-    qt1--;
-    dq = mul(d, uint64_t{qt1});
+    // divisor is greater than dividend, quotient is 0, remainder is dividend
+    rem = *this;
+    *this = 0;
   }
-  // subtract from remainder
-  auto rmdq = sub_5_digits(r_low64, r_high, dq.first, (uint16_t)dq.second, 0);
-  r_low64 = rmdq.first;
-  r_high = rmdq.second;
-
-  // low trial digit
-  uint16_t qt2 = (uint16_t)(get_3_digits(r_low64, r_high, 1) / d2);
-  dq = mul(d, uint64_t{qt2});
-  if (less_3_digits(r_low64, r_high, dq.first, low_bytes(dq.second)))
+  else
   {
-    // correct estimate
-    qt2--;
-    dq = mul(d, uint64_t{qt2});
+    const storage_t &l = data, &r = right.data;
+    // one more place for sign bit in both
+    storage_t quotient(n - m + 2, 0), remainder(m + 1, 0);
+    big_int_util::div_qr(quotient.data(), remainder.data(), l.data(), n, r.data(), m);
+    data.swap(quotient);
+    rem.data.swap(remainder);
+    shrink();
+    rem.shrink();
   }
-  // subtract from remainder
-  rmdq = sub_5_digits(r_low64, r_high, dq.first, (uint16_t)dq.second, 1);
-  r_low64 = rmdq.first;
-  r_high = rmdq.second;
+  rem.revert_sign(this_sign);
+  return revert_sign(sign);
+}
 
-  return {(uint32_t{qt1} << 16) | qt2, r_low64};
+big_integer & big_integer::operator/=(const big_integer &rhs)
+{
+  instrumentation::count_operation(instrumentation::op_div, std::max(size(), rhs.size()));
+  big_integer dummy;
+  return long_divide(rhs, dummy);
 }
 
-static std::pair<uint32_t, uint32_t> div2_1(uint32_t lhs_low, uint32_t lhs_high, uint32_t rhs)
+big_integer & big_integer::operator%=(const big_integer &rhs)
 {
-  uint64_t lhs = ((uint64_t{lhs_high} << 32) | lhs_low);
-  return {(uint32_t)(lhs / rhs), (uint32_t)(lhs % rhs)};
+  instrumentation::count_operation(instrumentation::op_mod, std::max(size(), rhs.size()));
+  big_integer(*this).long_divide(rhs, *this);
+  return *this;
 }
 
 /***
- * Rest of arithmetic operators for big_integer
+ * Fused operations: results are written to places of the destination,
+ * which are reused if they are not shared
  ***/
 
-big_integer & big_integer::operator+=(const big_integer &rhs)
+bool big_integer::short_magnitude(place_t &magnitude) const
 {
-  bool old_sign = sign_bit(), rhs_sign = rhs.sign_bit();
-  bool carry = 0;
-  iterate(rhs, [&](place_t l, place_t r) { return addc(l, r, carry); });
-  if (old_sign == rhs_sign)
-    correct_sign_bit(old_sign);
-
-  // 1... + 1... => 0... + carry  | new place
-  //                1... + carry  |
-  // 0... + 0... => 1... no carry | new place
-  //                0... no carry |
-  // 1... + 0... => 1... no carry |
-  //                0... + carry  |
-
-  return shrink();
+  if (unsigned_size() != 1)
+    return false;
+  const storage_t &d = data;
+  if (!sign_bit())
+  {
+    magnitude = d[0];
+    return true;
+  }
+  // -B does not fit
+  magnitude = 0 - d[0];
+  return magnitude != 0;
 }
 
-big_integer & big_integer::operator-=(const big_integer &rhs)
+big_integer::place_t * big_integer::reset(size_t new_size)
 {
-  return *this += -rhs;
+  // places are dropped first, so that none of them is copied if the buffer is reallocated
+  data.resize(0);
+  data.resize(new_size, 0);
+  return data.data();
 }
 
-// multiplication by a positive integer that fits into place_t
-big_integer & big_integer::short_multiply(place_t rhs)
+big_integer & big_integer::add_product(const big_integer &a, const big_integer &b, bool subtract)
 {
-  bool old_sign = make_absolute();
+  instrumentation::count_operation(instrumentation::op_mul, std::max(a.size(), b.size()));
+  // places of the operands are read while *this is written
+  if (&a == this || &b == this)
+    return add_product(big_integer(a), big_integer(b), subtract);
 
-  place_t carry = 0;
-  iterate([&](place_t datai)
-    {
-      auto res_carry = mul(datai, rhs);
-      bool add_carry = false;
-      place_t result = addc(res_carry.first, carry, add_carry);
-      carry = addc(res_carry.second, place_t{ 0 }, add_carry);
-      return result;
-    });
-  correct_sign_bit(0, carry);
-  return revert_sign(old_sign);
+  place_t factor;
+  const big_integer *other = &a;
+  bool short_factor = b.short_magnitude(factor);
+  if (!short_factor && a.short_magnitude(factor))
+  {
+    short_factor = true;
+    other = &b;
+  }
+  if (!short_factor)
+  {
+    // the product is added as a whole, it is adopted if *this is zero
+    big_integer product(a);
+    product *= b;
+    const storage_t &d = data;
+    if (d.size() != 1 || d[0] != 0)
+      return add_shifted(product, 0, subtract);
+    data.swap(product.data);
+    return subtract ? negate() : *this;
+  }
+
+  // the other factor is multiplied into places of *this: unsigned places of a negative one
+  // are its value + B^m, so factor * B^m is taken back from the higher places
+  bool minus = subtract ^ (other == &a ? b : a).sign_bit(), other_sign = other->sign_bit();
+  size_t m = other->size(), n = std::max(size(), m + 1) + 1;
+  instrumentation::count_operation(minus ? instrumentation::op_sub : instrumentation::op_add, n - 1);
+  resize(n);
+  place_t *l = data.data(), *rest = l + m;
+  const storage_t &r = other->data;
+  if (minus)
+  {
+    big_int_util::sub_1(rest, rest, n - m, big_int_util::submul_1(l, r.data(), m, factor));
+    if (other_sign)
+      big_int_util::add_1(rest, rest, n - m, factor);
+  }
+  else
+  {
+    big_int_util::add_1(rest, rest, n - m, big_int_util::addmul_1(l, r.data(), m, factor));
+    if (other_sign)
+      big_int_util::sub_1(rest, rest, n - m, factor);
+  }
+  return shrink();
 }
 
-big_integer & big_integer::operator*=(const big_integer &rhs)
+big_integer & addmul(big_integer &res, const big_integer &a, const big_integer &b)
 {
-  bool sign = make_absolute() ^ rhs.sign_bit();
-  big_integer right = rhs.sign_bit() ? -rhs : rhs;
-
-  big_integer res = 0;
-  int i = 0;
-  right.iterate([&](place_t rdatai)
-    {
-      res += big_integer(*this).short_multiply(rdatai) << ((int)i * PLACE_BITS);
-      i++;
-    });
-  return *this = res.revert_sign(sign);
+  return res.add_product(a, b, false);
 }
 
-// division by a positive integer that fits into place_t,
-// (requires place_t to be uint32_t because of div2_1)
-big_integer & big_integer::short_divide(place_t rhs, place_t &rem)
+big_integer & submul(big_integer &res, const big_integer &a, const big_integer &b)
 {
-  rem = 0;
-  iterate_r([&](place_t datai)
-    {
-      auto res_rem = div2_1(datai, rem, rhs);
-      rem = res_rem.second;
-      return res_rem.first;
-    });
-  return shrink();
+  return res.add_product(a, b, true);
 }
 
-// long division using algorithm with trial digits and division of prefixes
-// (requires place_t to be uint32_t because of short_divide, div2_1 & div3_2)
-big_integer & big_integer::long_divide(const big_integer &rhs, big_integer &rem)
+big_integer & mul(big_integer &res, const big_integer &a, const big_integer &b)
 {
-  bool this_sign = make_absolute(), sign = this_sign ^ rhs.sign_bit();
-
-  big_integer right = rhs.sign_bit() ? -rhs : rhs;
-
-  size_t n = unsigned_size(), m = right.unsigned_size();
+  if (&res == &a)
+    return res *= b;
+  if (&res == &b)
+    return res *= a;
+  res.reset(1);
+  return res.add_product(a, b, false);
+}
 
-  if (m == 1)
+big_integer & mul_2exp(big_integer &res, const big_integer &a, int bits)
+{
+  if (&res == &a || bits < 0)
   {
-    place_t r;
-    short_divide(right.data[0], r);
-    rem = big_integer(r);
+    res = a;
+    return res <<= bits;
   }
-  else if (m > n)
+  instrumentation::count_operation(instrumentation::op_shift, a.size());
+  size_t places = static_cast<size_t>(bits) / big_integer::PLACE_BITS, m = a.size(), n = places + m + 1;
+  int rest = bits % big_integer::PLACE_BITS;
+  big_integer::place_t fill = a.default_place();
+  big_integer::place_t *l = res.reset(n) + places;
+  const big_integer::storage_t &r = a.data;
+  if (rest == 0)
   {
-    // divisor is greater than dividend, quotient is 0, remainder is dividend
-    rem = *this;
-    *this = 0;
+    std::copy(r.data(), r.data() + m, l);
+    l[m] = fill;
   }
   else
-  {
-    // divide with base 2^PLACE_BITS
-    // 2 <= m <= n -- true
-
-    // copy operands: starting remainder is this, divisor is right
-    rem = *this;
-    big_integer d = right;
-
-    // normalize divisor d (largest place >= base / 2)
-    place_t f = d.data[m - 1] == std::numeric_limits<place_t>::max() ?
-      1 : div2_1(0, 1, d.data[m - 1] + 1).first;
-    rem.short_multiply(f);
-    d.short_multiply(f);
-
-    // 2 leading digits of divisor for quotient digits estimate
-    place_t d2_high = d.data[m - 1];
-    place_t d2_low = d.data[m - 2];
-    // compute quotient digits
-    std::vector<place_t> new_data(n - m + 1);
-    for (size_t ki = 0; ki <= n - m; ki++)
-    {
-      int k = (int)(n - m - ki);
-      // first, count 3 leading digits of remainder
-      place_t r3_high = k + m >= rem.data.size() ? 0 : rem.data[k + m];
-      place_t r3_med = k + m - 1 >= rem.data.size() ? 0 : rem.data[k + m - 1];
-      place_t r3_low = k + m - 2 >= rem.data.size() ? 0 : rem.data[k + m - 2];
-        // obtain k-th digit estimate
-      place_t qt = div3_2(r3_low, r3_med, r3_high, d2_low, d2_high).first;
-      // count result with estimate
-      big_integer dq = big_integer(d).short_multiply(qt) <<= k * PLACE_BITS;
-      if (rem < dq)
-      {
-        // wrong, correct estimate
-        qt--;
-        dq = big_integer(d).short_multiply(qt) <<= k * PLACE_BITS;
-      }
-      // set digit in quotient
-      new_data[k] = qt;
-      // subtract current result from remainder
-      rem -= dq;
-    }
-    place_t dummy;
-    rem.short_divide(f, dummy);
-    data = storage_t(new_data);
-    correct_sign_bit(0);
-  }
-  rem.revert_sign(this_sign);
-  return revert_sign(sign);
+    l[m] = big_int_util::lshift(l, r.data(), m, rest) | fill << rest;
+  return res.shrink();
 }
 
-big_integer & big_integer::operator/=(const big_integer &rhs)
-{
-  big_integer dummy;
-  return long_divide(rhs, dummy);
-}
-
-big_integer & big_integer::operator%=(const big_integer &rhs)
+void divmod(big_integer &q, big_integer &r, const big_integer &a, const big_integer &b)
 {
-  big_integer(*this).long_divide(rhs, *this);
-  return *this;
+  if (&q == &r)
+    throw std::invalid_argument("divmod: quotient and remainder must be different numbers");
+  // divisor must not be overwritten by the dividend (long_divide takes it before the remainder is changed)
+  if (&b == &q)
+  {
+    divmod(q, r, a, big_integer(b));
+    return;
+  }
+  instrumentation::count_operation(instrumentation::op_div, std::max(a.size(), b.size()));
+  q = a;
+  q.long_divide(b, r);
 }
 
 big_integer & big_integer::operator&=(const big_integer &rhs)
 {
+  instrumentation::count_operation(instrumentation::op_and, std::max(size(), rhs.size()));
   return place_wise(rhs, std::bit_and<place_t>());
 }
 
 big_integer & big_integer::operator|=(const big_integer &rhs)
 {
+  instrumentation::count_operation(instrumentation::op_or, std::max(size(), rhs.size()));
   return place_wise(rhs, std::bit_or<place_t>());
 }
 
 big_integer & big_integer::operator^=(const big_integer &rhs)
 {
+  instrumentation::count_operation(instrumentation::op_xor, std::max(size(), rhs.size()));
   return place_wise(rhs, std::bit_xor<place_t>());
 }
 
@@ -508,32 +503,45 @@ big_integer & big_integer::bit_shift(int rhs)
 {
   // rhs > 0 -> left shift
   // rhs < 0 -> right shift
-
-  // [lsrc][rsrc]
-  //       <-> bits
-  //    [plce]
-  bool sign = sign_bit();
-  int places = rhs / PLACE_BITS, bits = rhs % PLACE_BITS;
-  if (rhs < 0 && bits != 0)
-    places--, bits += PLACE_BITS;
-  std::vector<place_t> new_data(std::max(data.size() + places + (bits > 0), size_t{1}),
-                                get_or_default(rhs < 0 ?
-                                  static_cast<int64_t>(data.size()) : -1));
-  for (size_t i = std::max(places, 0); i < data.size() + places + (bits > 0); i++)
-  {
-    // handle PLACE_BITS shift undefined behavior with cases
-    if (bits == 0)
-      new_data[i] = data[i - places];
+  // done in place: memmove for whole places, one funnel shift pass for bits
+  instrumentation::count_operation(instrumentation::op_shift, size());
+  int64_t shift = rhs;
+  bool left = shift > 0;
+  if (!left)
+    shift = -shift;
+  size_t places = static_cast<size_t>(shift / PLACE_BITS);
+  int bits = static_cast<int>(shift % PLACE_BITS);
+  size_t n = size();
+  place_t fill = default_place();
+
+  if (left)
+  {
+    // one more (default) place for bits shifted out of the last one
+    size_t m = n + (bits > 0);
+    resize(m + places);
+    place_t *d = data.data();
+    if (bits > 0)
+      big_int_util::lshift(d + places, d, m, bits);
     else
-    {
-      place_t
-        lsrc = get_or_default(static_cast<int64_t>(i) - places),
-        rsrc = get_or_default(static_cast<int64_t>(i) - places - 1);
-      new_data[i] = (lsrc << bits) | (rsrc >> (PLACE_BITS - bits));
-    }
+      std::memmove(d + places, d, m * sizeof(place_t));
+    std::fill_n(d, places, 0);
+  }
+  else if (places >= n)
+  {
+    data.resize(1);
+    data.data()[0] = fill;
+  }
+  else
+  {
+    size_t m = n - places;
+    place_t *d = data.data();
+    if (bits > 0)
+      big_int_util::rshift(d, d + places, m, bits, fill);
+    else
+      std::memmove(d, d + places, m * sizeof(place_t));
+    data.resize(m);
   }
-  data = storage_t(new_data);
-  return correct_sign_bit(sign);
+  return shrink();
 }
 
 big_integer big_integer::operator+() const
@@ -543,12 +551,29 @@ big_integer big_integer::operator+() const
 
 big_integer big_integer::operator-() const
 {
-  return ~ *this + 1;
+  big_integer res = *this;
+  res.negate();
+  return res;
+}
+
+big_integer & big_integer::negate()
+{
+  instrumentation::count_operation(instrumentation::op_negate, size());
+  bool old_sign = sign_bit();
+  place_t *places = data.data();
+  if (big_int_util::neg_n(places, places, data.size()) && old_sign && sign_bit())
+    // the lowest negative number of this size, its absolute value needs one more place
+    data.push_back(0);
+  return shrink();
 }
 
 big_integer big_integer::operator~() const
 {
-  return big_integer().place_wise(*this, [](place_t x, place_t y) { return ~y; });
+  // inverting every place keeps the invariant
+  instrumentation::count_operation(instrumentation::op_not, size());
+  big_integer res = *this;
+  res.iterate([](place_t x) { return ~x; });
+  return res;
 }
 
 big_integer & big_integer::operator++()
@@ -575,54 +600,134 @@ big_integer big_integer::operator--(int)
   return r;
 }
 
+place_view big_integer::places() const
+{
+  return {data.data(), data.size()};
+}
+
 big_integer operator+(big_integer a, const big_integer &b)
 {
-  return a += b;
+  a += b;
+  return a;
 }
 
 big_integer operator-(big_integer a, const big_integer &b)
 {
-  return a -= b;
+  a -= b;
+  return a;
 }
 
 big_integer operator*(big_integer a, const big_integer &b)
 {
-  return a *= b;
+  a *= b;
+  return a;
 }
 
 big_integer operator/(big_integer a, const big_integer &b)
 {
-  return a /= b;
+  a /= b;
+  return a;
 }
 
 big_integer operator%(big_integer a, const big_integer &b)
 {
-  return a %= b;
+  a %= b;
+  return a;
 }
 
 big_integer operator&(big_integer a, const big_integer &b)
 {
-  return a &= b;
+  a &= b;
+  return a;
 }
 
 big_integer operator|(big_integer a, const big_integer &b)
 {
-  return a |= b;
+  a |= b;
+  return a;
 }
 
 big_integer operator^(big_integer a, const big_integer &b)
 {
-  return a ^= b;
+  a ^= b;
+  return a;
+}
+
+big_integer operator+(const big_integer &a, big_integer &&b)
+{
+  b += a;
+  return std::move(b);
+}
+
+big_integer operator+(big_integer &&a, big_integer &&b)
+{
+  if (a.size() < b.size())
+    return std::move(b += a);
+  return std::move(a += b);
+}
+
+big_integer operator*(const big_integer &a, big_integer &&b)
+{
+  b *= a;
+  return std::move(b);
+}
+
+big_integer operator*(big_integer &&a, big_integer &&b)
+{
+  if (a.size() < b.size())
+    return std::move(b *= a);
+  return std::move(a *= b);
+}
+
+big_integer operator&(const big_integer &a, big_integer &&b)
+{
+  b &= a;
+  return std::move(b);
+}
+
+big_integer operator&(big_integer &&a, big_integer &&b)
+{
+  if (a.size() < b.size())
+    return std::move(b &= a);
+  return std::move(a &= b);
+}
+
+big_integer operator|(const big_integer &a, big_integer &&b)
+{
+  b |= a;
+  return std::move(b);
+}
+
+big_integer operator|(big_integer &&a, big_integer &&b)
+{
+  if (a.size() < b.size())
+    return std::move(b |= a);
+  return std::move(a |= b);
+}
+
+big_integer operator^(const big_integer &a, big_integer &&b)
+{
+  b ^= a;
+  return std::move(b);
+}
+
+big_integer operator^(big_integer &&a, big_integer &&b)
+{
+  if (a.size() < b.size())
+    return std::move(b ^= a);
+  return std::move(a ^= b);
 }
 
 big_integer operator<<(big_integer a, int b)
 {
-  return a <<= b;
+  a <<= b;
+  return a;
 }
 
 big_integer operator>>(big_integer a, int b)
 {
-  return a >>= b;
+  a >>= b;
+  return a;
 }
 
 int big_integer::sign() const
@@ -636,6 +741,7 @@ int big_integer::sign() const
 
 int big_integer::compare(const big_integer &l, const big_integer &r)
 {
+  instrumentation::count_operation(instrumentation::op_compare, std::max(l.size(), r.size()));
   bool lsign = l.sign_bit(), rsign = r.sign_bit();
   if (lsign != rsign)
     return rsign - lsign;
@@ -655,14 +761,21 @@ int big_integer::compare(const big_integer &l, const big_integer &r)
 
 bool operator==(const big_integer &a, const big_integer &b)
 {
+  instrumentation::count_operation(instrumentation::op_compare, std::max(a.size(), b.size()));
   return a.data == b.data;
 }
 
 bool operator!=(const big_integer &a, const big_integer &b)
 {
+  instrumentation::count_operation(instrumentation::op_compare, std::max(a.size(), b.size()));
   return a.data != b.data;
 }
 
+size_t std::hash<big_integer>::operator()(const big_integer &a) const
+{
+  return static_cast<size_t>(a.data.hash());
+}
+
 bool operator<(const big_integer &a, const big_integer &b)
 {
   return big_integer::compare(a, b) < 0;
@@ -683,23 +796,493 @@ bool operator>=(const big_integer &a, const big_integer &b)
   return big_integer::compare(a, b) >= 0;
 }
 
-std::string to_string(const big_integer &a)
+big_integer pow_mod(const big_integer &base, const big_integer &exp, const big_integer &mod)
 {
-  big_integer c = a;
-  bool sgn = c.make_absolute();
-  std::string reverse;
+  if (exp.sign_bit())
+    throw std::invalid_argument("pow_mod: negative exponent");
+  if (mod == 0)
+    throw std::invalid_argument("pow_mod: zero modulus");
+  big_integer m = mod.sign_bit() ? -mod : mod, a = base % m;
+  if (a.sign_bit())
+    a += m;
+
+  const big_integer::storage_t &ad = a.data, &ed = exp.data, &md = m.data;
+  size_t mn = m.unsigned_size();
+  // one more place for sign bit
+  big_integer::storage_t res(mn + 1, 0);
+  big_int_util::pow_mod(res.data(), ad.data(), a.unsigned_size(), ed.data(), exp.unsigned_size(), md.data(), mn);
+  big_integer r;
+  r.data.swap(res);
+  return r.shrink();
+}
+
+big_integer gcd(const big_integer &a, const big_integer &b)
+{
+  big_integer x = a.sign_bit() ? -a : a, y = b.sign_bit() ? -b : b;
+  if (x == 0)
+    return y;
+  if (y == 0)
+    return x;
+
+  const big_integer::storage_t &xd = x.data, &yd = y.data;
+  size_t xn = x.unsigned_size(), yn = y.unsigned_size();
+  // one more place for sign bit
+  big_integer::storage_t res(std::min(xn, yn) + 1, 0);
+  big_int_util::gcd(res.data(), xd.data(), xn, yd.data(), yn);
+  big_integer r;
+  r.data.swap(res);
+  return r.shrink();
+}
+
+big_integer extended_gcd(const big_integer &a, const big_integer &b, big_integer &x, big_integer &y)
+{
+  bool a_sign = a.sign_bit(), b_sign = b.sign_bit();
+  big_integer abs_a = a_sign ? -a : a, abs_b = b_sign ? -b : b;
+  if (abs_a == 0 || abs_b == 0)
+  {
+    // gcd is the other operand
+    x = abs_b == 0 ? big_integer(a.sign()) : 0;
+    y = abs_b == 0 ? 0 : big_integer(b.sign());
+    return abs_a + abs_b;
+  }
+
+  const big_integer::storage_t &ad = abs_a.data, &bd = abs_b.data;
+  size_t an = abs_a.unsigned_size(), bn = abs_b.unsigned_size();
+  // one more place for sign bit in both
+  big_integer::storage_t g_places(std::min(an, bn) + 1, 0), s_places(bn + 1, 0);
+  bool s_negative;
+  big_int_util::gcdext(g_places.data(), s_places.data(), s_negative, ad.data(), an, bd.data(), bn);
+  big_integer g, s;
+  g.data.swap(g_places);
+  s.data.swap(s_places);
+  g.shrink();
+  s.shrink().revert_sign(s_negative);
+
+  // the other cofactor is found from the identity, the division is exact
+  big_integer t = (g - abs_a * s) / abs_b;
+  x = a_sign ? -s : s;
+  y = b_sign ? -t : t;
+  return g;
+}
+
+big_integer mod_inverse(const big_integer &a, const big_integer &mod)
+{
+  if (mod == 0)
+    throw std::invalid_argument("mod_inverse: zero modulus");
+  big_integer m = mod < 0 ? -mod : mod;
+  if (m == 1)
+    return 0;
+  big_integer r = a % m, x, y;
+  if (r < 0)
+    r += m;
+  if (extended_gcd(r, m, x, y) != 1)
+    throw std::invalid_argument("mod_inverse: not invertible");
+  if (x < 0)
+    x += m;
+  return x;
+}
+
+namespace
+{
+  // x^k, k >= 0
+  big_integer power(big_integer x, size_t k)
+  {
+    big_integer res = 1;
+    for (; k != 0; k >>= 1)
+    {
+      if (k & 1)
+        res *= x;
+      if (k > 1)
+        x *= x;
+    }
+    return res;
+  }
+
+  // r^k <= v, without overflow
+  bool power_at_most(uint64_t r, int k, uint64_t v)
+  {
+    uint64_t p = 1;
+    for (int i = 0; i < k; i++)
+    {
+      if (r != 0 && p > v / r)
+        return false;
+      p *= r;
+    }
+    return p <= v;
+  }
+
+  // x^k mod B
+  big_int_util::place_t power_place(big_int_util::place_t x, big_int_util::place_t k)
+  {
+    big_int_util::place_t res = 1;
+    for (; k != 0; k >>= 1, x *= x)
+      if (k & 1)
+        res *= x;
+    return res;
+  }
+
+  bool is_prime(size_t k)
+  {
+    if (k < 2)
+      return false;
+    for (size_t d = 2; d * d <= k; d++)
+      if (k % d == 0)
+        return false;
+    return true;
+  }
+
+  // x^e mod p, p < 2^32
+  uint64_t power_mod_small(uint64_t x, uint64_t e, uint64_t p)
+  {
+    uint64_t res = 1;
+    for (x %= p; e != 0; e >>= 1, x = x * x % p)
+      if (e & 1)
+        res = res * x % p;
+    return res;
+  }
+}
+
+big_integer big_integer::nonnegative_root(const big_integer &n, int k)
+{
+  size_t bits = n.bit_length();
+  // n < 2^k
+  if (bits <= static_cast<size_t>(k))
+    return n == 0 ? 0 : 1;
+
+  if (bits <= 64)
+  {
+    // floating point estimate, corrected exactly
+    const storage_t &d = n.data;
+    uint64_t v = 0;
+    for (size_t i = 0; i < n.unsigned_size(); i++)
+      v |= static_cast<uint64_t>(d[i]) << (i * PLACE_BITS);
+    uint64_t r = static_cast<uint64_t>(std::pow(static_cast<double>(v), 1.0 / k));
+    while (r > 0 && !power_at_most(r, k, v))
+      r--;
+    while (power_at_most(r + 1, k, v))
+      r++;
+    // r < 2^32 as k >= 2
+    return big_integer(static_cast<place_t>(r));
+  }
+
+  if (k == 2)
+    return sqrt_rem(n, nullptr);
+
+  // root of the top half of bits gives half of the root bits: (r + 1) * 2^j is at least the root
+  size_t j = bits / (2 * k);
+  big_integer x;
+  if (j == 0)
+  {
+    // n < 2^(2k), the root is less than 4
+    x = 1;
+    while (power(x + 1, k) <= n)
+      x += 1;
+    return x;
+  }
+  x = (nonnegative_root(n >> static_cast<int>(k * j), k) + 1) << static_cast<int>(j);
+
+  // Newton's iteration decreases to the root from above without passing it, and the estimate
+  // is close, so its first step is usually already the root: y^k is cheaper than the next division
+  for (;;)
+  {
+    big_integer y = (x * (k - 1) + n / power(x, k - 1)) / k;
+    if (y >= x)
+      return x;
+    if (power(y, k) <= n)
+      return y;
+    x = std::move(y);
+  }
+}
+
+big_integer big_integer::sqrt_rem(const big_integer &n, big_integer *rem)
+{
+  size_t bits = n.bit_length();
+  if (bits <= 64)
+  {
+    big_integer s = nonnegative_root(n, 2);
+    if (rem != nullptr)
+      *rem = n - s * s;
+    return s;
+  }
+
+  // Zimmermann's Karatsuba square root: n * 4^c = a3 * 2^3h + a2 * 2^2h + a1 * 2^h + a0 with a3 >= 2^(h - 2),
+  // the root of the top half gives the high half of the root, one division of half size gives the low one
+  size_t h = (bits + 3) / 4, c = (4 * h - bits) / 2;
+  int ih = static_cast<int>(h);
+  big_integer m = n << static_cast<int>(2 * c), mask = (big_integer(1) << ih) - 1, r;
+  big_integer s = sqrt_rem(m >> 2 * ih, &r) << 1;
+  big_integer u;
+  big_integer q = (r << ih) | ((m >> ih) & mask);
+  q.long_divide(s, u);
+  s = (s << (ih - 1)) + q;
+  r = ((u << ih) | (m & mask)) - q * q;
+  if (r < 0)
+  {
+    r += s * 2 - 1;
+    s -= 1;
+  }
+
   if (c == 0)
-    reverse.push_back('0');
-  while (c != 0)
   {
-    uint32_t rem;
-    c.short_divide(10, rem);
-    reverse += static_cast<char>((static_cast<char>(rem) + '0'));
+    if (rem != nullptr)
+      *rem = std::move(r);
+    return s;
   }
-  if (sgn)
-    reverse.push_back('-');
+  s >>= static_cast<int>(c);
+  if (rem != nullptr)
+    *rem = n - s * s;
+  return s;
+}
 
-  return std::string(reverse.rbegin(), reverse.rend());
+big_integer isqrt(const big_integer &n)
+{
+  if (n < 0)
+    throw std::invalid_argument("isqrt: negative number");
+  return iroot(n, 2);
+}
+
+big_integer iroot(const big_integer &n, int k)
+{
+  if (k < 1 || (k % 2 == 0 && n.sign_bit()))
+    throw std::invalid_argument("iroot: even root of negative number or non-positive degree");
+  if (k == 1)
+    return n;
+  if (n.sign_bit())
+    return -big_integer::nonnegative_root(-n, k);
+  return big_integer::nonnegative_root(n, k);
+}
+
+bool is_perfect_power(const big_integer &n)
+{
+  using big_int_util::place_t;
+  bool negative = n.sign_bit();
+  big_integer a = negative ? -n : n;
+  if (a <= 1)
+    return true;
+
+  // a = 2^t * odd, 2^t must be a power of the same degree
+  size_t bits = a.bit_length(), t = 0;
+  {
+    const big_integer::storage_t &d = a.data;
+    while (d[t / big_integer::PLACE_BITS] == 0)
+      t += big_integer::PLACE_BITS;
+    for (place_t low = d[t / big_integer::PLACE_BITS]; (low & 1) == 0; low >>= 1)
+      t++;
+  }
+  big_integer odd = a >> static_cast<int>(t);
+  size_t odd_bits = odd.bit_length();
+  const big_integer::storage_t &odd_data = odd.data;
+  place_t low = odd_data[0];
+
+  // a k-th power is a k-th power residue modulo every prime p = 1 (mod k), and a non-residue
+  // is one of (k - 1) / k of them, so a few such primes reject a non-power before its root is taken
+  auto is_power_residue = [&](size_t k)
+  {
+    int checked = 0;
+    for (uint64_t p = 2 * k + 1; checked < 4 && p >> 32 == 0; p += 2 * k)
+    {
+      if (!is_prime(p))
+        continue;
+      checked++;
+      uint64_t r = 0;
+      for (size_t i = odd.unsigned_size(); i > 0; i--)
+        for (int shift = big_integer::PLACE_BITS - 32; shift >= 0; shift -= 32)
+          r = ((r << 32) | static_cast<uint32_t>(odd_data[i - 1] >> shift)) % p;
+      if (r != 0 && power_mod_small(r, (p - 1) / k, p) != 1)
+        return false;
+    }
+    return true;
+  };
+
+  // it is enough to check prime degrees, a power of negative number is negative only for odd degree
+  for (size_t k = negative ? 3 : 2; k < bits; k++)
+  {
+    if ((t != 0 && t % k != 0) || !is_prime(k))
+      continue;
+    if (k == 2)
+    {
+      if (!is_power_residue(k))
+        continue;
+      big_integer r = big_integer::nonnegative_root(odd, 2);
+      if (r * r == odd)
+        return true;
+      continue;
+    }
+
+    // odd root of odd number modulo B is unique: low^(1/k) = low^(k^-1 mod B/2)
+    place_t inv = static_cast<place_t>(k);
+    for (int i = 3; i < big_integer::PLACE_BITS; i *= 2)
+      inv *= 2 - static_cast<place_t>(k) * inv;
+    place_t low_root = power_place(low, inv);
+    size_t root_bits = (odd_bits + k - 1) / k;
+    big_integer r;
+    if (root_bits <= static_cast<size_t>(big_integer::PLACE_BITS))
+    {
+      // the root is a single place, so it is low_root, and it must have the right length
+      r = big_integer(low_root);
+      if (r.bit_length() != root_bits)
+        continue;
+    }
+    else
+    {
+      if (!is_power_residue(k))
+        continue;
+      r = big_integer::nonnegative_root(odd, static_cast<int>(k));
+      const big_integer::storage_t &root_data = r.data;
+      if (root_data[0] != low_root)
+        continue;
+    }
+    if (power(r, k) == odd)
+      return true;
+  }
+  return false;
+}
+
+std::string to_string(const big_integer &a, int base)
+{
+  if (!big_int_util::is_valid_base(base))
+    throw std::invalid_argument("to_string: base must be in [2, 36]");
+  std::string res(to_chars_max_length(a, base), '\0');
+  res.resize(static_cast<size_t>(to_chars(&res[0], &res[0] + res.size(), a, base).ptr - res.data()));
+  return res;
+}
+
+size_t to_chars_max_length(const big_integer &a, int base)
+{
+  return big_int_util::max_digits(a.size(), base) + a.sign_bit();
+}
+
+to_chars_result to_chars(char *first, char *last, const big_integer &a, int base)
+{
+  if (!big_int_util::is_valid_base(base))
+    return {first, std::errc::invalid_argument};
+  size_t max_length = to_chars_max_length(a, base);
+  if (static_cast<size_t>(last - first) < max_length)
+  {
+    // may still fit, so convert to a temporary buffer
+    std::string buf = to_string(a, base);
+    if (static_cast<size_t>(last - first) < buf.size())
+      return {last, std::errc::value_too_large};
+    return {std::copy(buf.begin(), buf.end(), first), std::errc()};
+  }
+
+  instrumentation::count_operation(instrumentation::op_to_string, a.size());
+  big_integer c = a;
+  if (c.make_absolute())
+    *first++ = '-';
+  const big_integer::storage_t &data = c.data;
+  first += big_int_util::to_digits(first, data.data(), c.unsigned_size(), base);
+  return {first, std::errc()};
+}
+
+from_chars_result from_chars(const char *first, const char *last, big_integer &a, int base)
+{
+  if (!big_int_util::is_valid_base(base))
+    return {first, std::errc::invalid_argument};
+  const char *it = first;
+  bool is_negated = it != last && *it == '-';
+  if (is_negated)
+    it++;
+  const char *digits = it;
+  while (it != last && big_int_util::digit_value(*it, base) >= 0)
+    it++;
+  if (it == digits)
+    return {first, std::errc::invalid_argument};
+
+  size_t len = static_cast<size_t>(it - digits);
+  // one more place for sign bit
+  big_integer::storage_t res(big_int_util::max_digit_places(len, base) + 1, 0);
+  instrumentation::count_operation(instrumentation::op_from_string, res.size());
+  big_int_util::from_digits(res.data(), digits, len, base);
+  a.data.swap(res);
+  a.shrink().revert_sign(is_negated);
+  return {it, std::errc()};
+}
+
+namespace
+{
+  constexpr size_t PLACE_BYTES = sizeof(big_int_util::place_t);
+
+  // i-th byte of little-endian places
+  unsigned char place_byte(const big_int_util::place_t *places, size_t i)
+  {
+    return static_cast<unsigned char>(places[i / PLACE_BYTES] >> (i % PLACE_BYTES * 8));
+  }
+}
+
+size_t export_bytes_length(const big_integer &a, sign_encoding encoding)
+{
+  // magnitude with the sign bit takes as many bytes as its 2's complement
+  if (encoding == sign_encoding::sign_magnitude && a.sign_bit())
+    return export_bytes_length(-a, sign_encoding::twos_complement);
+
+  const big_integer::storage_t &d = a.data;
+  const big_int_util::place_t *places = d.data();
+  unsigned char def = static_cast<unsigned char>(a.default_place()), sign = def & 0x80;
+  size_t n = d.size() * PLACE_BYTES;
+  // while the highest byte is default and no change in sign
+  while (n > 1 && place_byte(places, n - 1) == def && (place_byte(places, n - 2) & 0x80) == sign)
+    n--;
+  return n;
+}
+
+unsigned char * export_bytes(unsigned char *out, const big_integer &a, byte_order order, sign_encoding encoding)
+{
+  if (encoding == sign_encoding::sign_magnitude && a.sign_bit())
+  {
+    unsigned char *end = export_bytes(out, -a, order, sign_encoding::twos_complement);
+    (order == byte_order::big_endian ? out[0] : end[-1]) |= 0x80;
+    return end;
+  }
+
+  size_t n = export_bytes_length(a, sign_encoding::twos_complement);
+  const big_integer::storage_t &d = a.data;
+  const big_int_util::place_t *places = d.data();
+  if (order == byte_order::little_endian)
+    for (size_t i = 0; i < n; i++)
+      out[i] = place_byte(places, i);
+  else
+    for (size_t i = 0; i < n; i++)
+      out[n - 1 - i] = place_byte(places, i);
+  return out + n;
+}
+
+std::vector<unsigned char> export_bytes(const big_integer &a, byte_order order, sign_encoding encoding)
+{
+  std::vector<unsigned char> res(export_bytes_length(a, encoding));
+  export_bytes(res.data(), a, order, encoding);
+  return res;
+}
+
+big_integer import_bytes(const unsigned char *in, size_t n, byte_order order, sign_encoding encoding)
+{
+  using big_int_util::place_t;
+  big_integer res;
+  if (n == 0)
+    return res;
+
+  bool big_endian = order == byte_order::big_endian;
+  auto byte = [=](size_t i) { return big_endian ? in[n - 1 - i] : in[i]; };
+  bool sign = byte(n - 1) & 0x80;
+  // one more place for sign bit
+  big_integer::storage_t data(n / PLACE_BYTES + 1, 0);
+  place_t *places = data.data();
+  for (size_t i = 0; i < n; i++)
+    places[i / PLACE_BYTES] |= static_cast<place_t>(byte(i)) << (i % PLACE_BYTES * 8);
+  if (sign)
+  {
+    if (encoding == sign_encoding::sign_magnitude)
+      // clear the sign, leaving the magnitude
+      places[(n - 1) / PLACE_BYTES] ^= place_t{0x80} << ((n - 1) % PLACE_BYTES * 8);
+    else
+      // extend the sign over the rest of the last place
+      places[n / PLACE_BYTES] |= ~place_t{0} << (n % PLACE_BYTES * 8);
+  }
+  res.data.swap(data);
+  res.shrink();
+  if (encoding == sign_encoding::sign_magnitude)
+    res.revert_sign(sign);
+  return res;
 }
 
 std::ostream & operator<<(std::ostream &s, const big_integer &a)
@@ -8,16 +8,65 @@
 #include <cstdint>
 #include <vector>
 #include <string>
+#include <system_error>
 #include <functional>
 
 #include "optimized_buffer.h"
+#include "limb_arithmetic.h"
 
+// results of character conversions (the same as of std::to_chars and std::from_chars)
+struct to_chars_result
+{
+  char *ptr;
+  std::errc ec;
+};
+
+struct from_chars_result
+{
+  const char *ptr;
+  std::errc ec;
+};
+
+// binary representation of export_bytes and import_bytes (like mpz_export and mpz_import, but with sign)
+enum class byte_order
+{
+  little_endian,
+  big_endian
+};
+
+enum class sign_encoding
+{
+  // the highest bit of the most significant byte is the sign of the whole
+  twos_complement,
+  // magnitude, the highest bit of its most significant byte is the sign
+  sign_magnitude
+};
+
+// read-only places of a number: little-endian 2's complement, the highest bit of the last place is the sign
+struct place_view
+{
+  const big_int_util::place_t *data;
+  size_t size;
+};
+
+/***
+ * Thread safety: places are shared between copies (copy-on-write), so
+ * - without BIGINT_ATOMIC_REFCOUNT an instance and all its copies must be used by
+ *   a single thread at a time (even copying it is a data race);
+ * - with BIGINT_ATOMIC_REFCOUNT copies are independent: different instances
+ *   (whether or not they share places) can be used from different threads, and one
+ *   instance can be used concurrently by const operations only (const members,
+ *   copying, comparisons, to_string, right operand of compound assignments, operands
+ *   of free binary operators), as with standard library types;
+ * - algorithm thresholds (*_thresholds structs) must not be changed concurrently
+ *   with any arithmetic.
+ ***/
 struct big_integer
 {
 /* all public functions provide weak exception guarantee (invariant holds) */
 private:
-  // digit type -- only uint32_t supported because of division
-  using place_t = uint32_t;
+  // digit type -- 32 or 64-bit, chosen by BIGINT_PLACE_BITS (see limb_arithmetic.h)
+  using place_t = big_int_util::place_t;
   // reserve 2 places for sign & carry
   using storage_t = big_int_util::optimized_buffer;
 
@@ -25,16 +74,23 @@ private:
   // sign -- highest bit in last place (1 -- negative)
   // data has the smallest size representing the same number in 2's complement form
   storage_t data;
-  static constexpr int PLACE_BITS = std::numeric_limits<place_t>::digits;
+  static constexpr int PLACE_BITS = big_int_util::PLACE_BITS;
 
 public:
   big_integer();
   big_integer(const big_integer &other) = default;
+  // moved-from number is left equal to zero
+  big_integer(big_integer &&other) noexcept;
   big_integer(int a);
-  explicit big_integer(std::string const &str);
+  // digits in base 2..36 with optional '-' (std::invalid_argument is thrown for other bases)
+  explicit big_integer(std::string const &str, int base = 10);
+  // adopts places without copying (they may also have redundant sign places): they are copied
+  // on the first modification, so they must stay unchanged while the number or any of its copies exists
+  explicit big_integer(place_view places);
   ~big_integer();
 
   big_integer & operator=(const big_integer &other);
+  big_integer & operator=(big_integer &&other) noexcept;
 
   big_integer & operator+=(const big_integer &rhs);
   big_integer & operator-=(const big_integer &rhs);
@@ -59,6 +115,16 @@ public:
   big_integer & operator--();
   big_integer operator--(int);
 
+  // valid until the number is modified or destroyed
+  place_view places() const;
+
+  // commutative operations on two temporaries are done in place of the longer one
+  friend big_integer operator+(big_integer &&a, big_integer &&b);
+  friend big_integer operator*(big_integer &&a, big_integer &&b);
+  friend big_integer operator&(big_integer &&a, big_integer &&b);
+  friend big_integer operator|(big_integer &&a, big_integer &&b);
+  friend big_integer operator^(big_integer &&a, big_integer &&b);
+
   friend bool operator==(const big_integer &a, const big_integer &b);
   friend bool operator!=(const big_integer &a, const big_integer &b);
   friend bool operator<(const big_integer &a, const big_integer &b);
@@ -66,18 +132,53 @@ public:
   friend bool operator<=(const big_integer &a, const big_integer &b);
   friend bool operator>=(const big_integer &a, const big_integer &b);
 
-  friend std::string to_string(const big_integer &a);
+  friend big_integer pow_mod(const big_integer &base, const big_integer &exp, const big_integer &mod);
+  friend big_integer gcd(const big_integer &a, const big_integer &b);
+  friend big_integer extended_gcd(const big_integer &a, const big_integer &b, big_integer &x, big_integer &y);
+  friend big_integer iroot(const big_integer &n, int k);
+  friend bool is_perfect_power(const big_integer &n);
+
+  friend std::string to_string(const big_integer &a, int base);
+  friend size_t to_chars_max_length(const big_integer &a, int base);
+  friend to_chars_result to_chars(char *first, char *last, const big_integer &a, int base);
+  friend from_chars_result from_chars(const char *first, const char *last, big_integer &a, int base);
+
+  friend struct std::hash<big_integer>;
+
+  friend size_t export_bytes_length(const big_integer &a, sign_encoding encoding);
+  friend unsigned char * export_bytes(unsigned char *out, const big_integer &a, byte_order order, sign_encoding encoding);
+  friend big_integer import_bytes(const unsigned char *in, size_t n, byte_order order, sign_encoding encoding);
+
+  friend big_integer & mul(big_integer &res, const big_integer &a, const big_integer &b);
+  friend big_integer & mul_2exp(big_integer &res, const big_integer &a, int bits);
+  friend void divmod(big_integer &q, big_integer &r, const big_integer &a, const big_integer &b);
+  friend big_integer & addmul(big_integer &res, const big_integer &a, const big_integer &b);
+  friend big_integer & submul(big_integer &res, const big_integer &a, const big_integer &b);
+
+  // conversion from fixed_integer fills places directly
+  template<size_t Bits, bool Signed>
+  friend struct fixed_integer;
 
 private:
   explicit big_integer(place_t place);
 
   /* Operators */
-  big_integer & short_multiply(place_t rhs);
+  // *this +=/-= rhs * 2^(offset * PLACE_BITS), done in place
+  big_integer & add_shifted(const big_integer &rhs, size_t offset, bool subtract);
+  big_integer & sub_shifted(const big_integer &rhs, size_t offset);
+  big_integer & negate();
   big_integer & long_divide(const big_integer &rhs, big_integer &rem);
-  big_integer & short_divide(place_t rhs, place_t &rem);
   big_integer & bit_shift(int bits);
   static int compare(const big_integer &l, const big_integer &r);
 
+  /* Fused operations */
+  // *this +=/-= a * b, a factor of a single place is multiplied without a product buffer
+  big_integer & add_product(const big_integer &a, const big_integer &b, bool subtract);
+  // absolute value if it fits into a single place
+  bool short_magnitude(place_t &magnitude) const;
+  // destroys invariant: new_size zero places, the buffer is reused if it is not shared
+  place_t * reset(size_t new_size);
+
   /* Invariant-changing functions */
   // corrects sign & invariant
   big_integer & correct_sign_bit(bool expected_sign_bit, place_t carry = 0);
@@ -96,20 +197,22 @@ private:
   size_t size() const;
   size_t unsigned_size() const;
   place_t default_place() const;
-  place_t get_or_default(int64_t at) const;
-
-  /* Useful iterating functions */
-  using binary_operator = std::function<place_t (place_t, place_t)>;
-  using unary_operator = std::function<place_t (place_t)>;
-  using unary_consumer = std::function<void (place_t)>;
-
-  void iterate(const big_integer &b, const binary_operator &action);
-  void iterate(const unary_operator &action);
-  void iterate_r(const unary_operator &action);
-  void iterate(const unary_consumer &action) const;
-  void iterate_r(const unary_consumer &action) const;
-  big_integer & place_wise(const big_integer &b,
-    const binary_operator &action);
+  // of non-negative number
+  size_t bit_length() const;
+
+  /* Roots */
+  // floor(n^(1/k)), n >= 0, k >= 2
+  static big_integer nonnegative_root(const big_integer &n, int k);
+  // floor(sqrt(n)), n - root^2 is stored to rem if it is not null
+  static big_integer sqrt_rem(const big_integer &n, big_integer *rem);
+
+  /* Useful iterating functions (templates, so that actions are inlined) */
+  template<typename binary_operator>
+    void iterate(const big_integer &b, binary_operator action);
+  template<typename unary_operator>
+    void iterate(unary_operator action);
+  template<typename binary_operator>
+    big_integer & place_wise(const big_integer &b, binary_operator action);
 };
 
 big_integer operator+(big_integer a, const big_integer &b);
@@ -122,6 +225,19 @@ big_integer operator&(big_integer a, const big_integer &b);
 big_integer operator|(big_integer a, const big_integer &b);
 big_integer operator^(big_integer a, const big_integer &b);
 
+// rvalue right operand of commutative operations is reused as the result
+big_integer operator+(const big_integer &a, big_integer &&b);
+big_integer operator*(const big_integer &a, big_integer &&b);
+big_integer operator&(const big_integer &a, big_integer &&b);
+big_integer operator|(const big_integer &a, big_integer &&b);
+big_integer operator^(const big_integer &a, big_integer &&b);
+
+big_integer operator+(big_integer &&a, big_integer &&b);
+big_integer operator*(big_integer &&a, big_integer &&b);
+big_integer operator&(big_integer &&a, big_integer &&b);
+big_integer operator|(big_integer &&a, big_integer &&b);
+big_integer operator^(big_integer &&a, big_integer &&b);
+
 big_integer operator<<(big_integer a, int b);
 big_integer operator>>(big_integer a, int b);
 
@@ -132,7 +248,67 @@ bool operator>(const big_integer &a, const big_integer &b);
 bool operator<=(const big_integer &a, const big_integer &b);
 bool operator>=(const big_integer &a, const big_integer &b);
 
-std::string to_string(const big_integer &a);
+// fused operations write the result to places of the destination (reused if they are not shared),
+// operands may be the destination itself;
+// res += a * b and res -= a * b (without a temporary product if a factor fits into a place)
+big_integer & addmul(big_integer &res, const big_integer &a, const big_integer &b);
+big_integer & submul(big_integer &res, const big_integer &a, const big_integer &b);
+// res = a * b
+big_integer & mul(big_integer &res, const big_integer &a, const big_integer &b);
+// res = a * 2^bits (floor(a / 2^-bits) for negative bits, as a << bits)
+big_integer & mul_2exp(big_integer &res, const big_integer &a, int bits);
+// q = a / b and r = a % b by a single division (std::invalid_argument is thrown if q and r are the same number)
+void divmod(big_integer &q, big_integer &r, const big_integer &a, const big_integer &b);
+
+// base^exp modulo |mod| in [0, |mod|), exp >= 0 and mod != 0 (otherwise std::invalid_argument is thrown)
+big_integer pow_mod(const big_integer &base, const big_integer &exp, const big_integer &mod);
+// greatest common divisor (non-negative, gcd(0, 0) = 0)
+big_integer gcd(const big_integer &a, const big_integer &b);
+// returns gcd(a, b) = a * x + b * y, |x| <= max(|b| / gcd, 1), |y| <= max(|a| / gcd, 1)
+big_integer extended_gcd(const big_integer &a, const big_integer &b, big_integer &x, big_integer &y);
+// inverse of a modulo |mod| in [0, |mod|), std::invalid_argument is thrown if mod = 0 or it does not exist
+big_integer mod_inverse(const big_integer &a, const big_integer &mod);
+// floor(sqrt(n)), std::invalid_argument is thrown for n < 0
+big_integer isqrt(const big_integer &n);
+// k-th root rounded toward zero, k >= 1, n >= 0 for even k (otherwise std::invalid_argument is thrown)
+big_integer iroot(const big_integer &n, int k);
+// true if n = m^k for some integers m, k >= 2 (so 0, 1 and -1 are)
+bool is_perfect_power(const big_integer &n);
+
+// representations are in base 2..36 (lowercase letters are written, both cases are read),
+// power-of-two bases are converted in linear time, to_string throws std::invalid_argument for other bases
+std::string to_string(const big_integer &a, int base = 10);
+// upper bound of representation length (with sign)
+size_t to_chars_max_length(const big_integer &a, int base = 10);
+// writes representation to [first, last) without terminating zero,
+// on failure returns {last, std::errc::value_too_large} ({first, std::errc::invalid_argument} for a wrong base)
+to_chars_result to_chars(char *first, char *last, const big_integer &a, int base = 10);
+// reads longest representation ('-' and digits) from the beginning of [first, last),
+// on failure a is unchanged and {first, std::errc::invalid_argument} is returned
+from_chars_result from_chars(const char *first, const char *last, big_integer &a, int base = 10);
+
+// length of binary representation: the smallest number of bytes holding the sign bit (at least 1)
+size_t export_bytes_length(const big_integer &a, sign_encoding encoding = sign_encoding::twos_complement);
+// writes export_bytes_length(a, encoding) bytes to out, returns pointer past the last one
+unsigned char * export_bytes(unsigned char *out, const big_integer &a,
+                             byte_order order = byte_order::little_endian,
+                             sign_encoding encoding = sign_encoding::twos_complement);
+std::vector<unsigned char> export_bytes(const big_integer &a, byte_order order = byte_order::little_endian,
+                                        sign_encoding encoding = sign_encoding::twos_complement);
+// reads number from in[0..n) (of any length, n = 0 is zero)
+big_integer import_bytes(const unsigned char *in, size_t n, byte_order order = byte_order::little_endian,
+                         sign_encoding encoding = sign_encoding::twos_complement);
 std::ostream & operator<<(std::ostream &s, const big_integer &a);
 
+namespace std
+{
+  // hash of places of the invariant form, so equal numbers have equal hashes
+  // (it is cached in shared places, so copies of a number are hashed once)
+  template<>
+  struct hash<big_integer>
+  {
+    size_t operator()(const big_integer &a) const;
+  };
+}
+
 #endif // BIG_INTEGER_H
@@ -0,0 +1,442 @@
+/* Nikolai Kholiavin, M3138 */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "big_integer.h"
+#include "big_integer_gmp.h"
+#include "expression.h"
+#include "multiplication.h"
+#include "optimized_buffer.h"
+#include "parallel.h"
+#include "place_pool.h"
+
+namespace
+{
+  std::mt19937 rng(42);
+
+  // random non-negative number of at most 'places' 32-bit places (built in O(n log n) time)
+  big_integer random_big(size_t places)
+  {
+    if (places == 1)
+      return big_integer(static_cast<int>(rng() >> 1)) << 1 | big_integer(static_cast<int>(rng() & 1));
+    size_t half = places / 2;
+    return random_big(places - half) << static_cast<int>(half * 32) | random_big(half);
+  }
+
+  big_integer_gmp random_gmp(size_t places)
+  {
+    big_integer_gmp res;
+    res.random(places * 32 - 1, rng);
+    return res < 0 ? -res : res;
+  }
+
+  // average time of f in nanoseconds, repeated for at least 'min_time' seconds
+  template<typename F>
+  double measure(F f, double min_time = 0.2)
+  {
+    using clock = std::chrono::steady_clock;
+    f();
+    size_t runs = 0;
+    auto start = clock::now();
+    std::chrono::duration<double> elapsed{0};
+    do
+    {
+      f();
+      runs++;
+      elapsed = clock::now() - start;
+    } while (elapsed.count() < min_time);
+    return elapsed.count() * 1e9 / runs;
+  }
+
+  // average time of f in nanoseconds as measure, 'prepare' is called untimed before every 'batch' runs of f
+  template<typename P, typename F>
+  double measure_prepared(P prepare, F f, size_t batch, double min_time = 0.2)
+  {
+    using clock = std::chrono::steady_clock;
+    prepare();
+    f();
+    size_t runs = 0;
+    std::chrono::duration<double> elapsed{0};
+    do
+    {
+      prepare();
+      auto start = clock::now();
+      for (size_t i = 0; i < batch; i++)
+        f();
+      elapsed += clock::now() - start;
+      runs += batch;
+    } while (elapsed.count() < min_time);
+    return elapsed.count() * 1e9 / runs;
+  }
+
+  /* Sweep of all operations over operand sizes against GMP, reported as JSON */
+  struct sweep_options
+  {
+    size_t max_limbs = 100000;
+    double min_time = 0.1;
+    // larger sizes of an operation are skipped once they are expected
+    // (with quadratic growth) to take longer than this, in seconds
+    double max_op_time = 1.0;
+  };
+
+  class sweep
+  {
+  public:
+    explicit sweep(const sweep_options &options) : options(options)
+    {}
+
+    // operand sizes are in 32-bit limbs, whatever places the implementation uses
+    void run(const char *implementation, int place_bits)
+    {
+      static const size_t sizes[] = {1, 4, 16, 64, 256, 1024, 4096, 16384, 65536, 100000};
+      std::printf("{\n  \"implementation\": \"%s\",\n  \"place_bits\": %d,\n  \"limb_bits\": 32,\n"
+                  "  \"min_time_s\": %g,\n  \"results\": [", implementation, place_bits, options.min_time);
+      for (size_t limbs : sizes)
+      {
+        if (limbs > options.max_limbs)
+          break;
+        run_size(limbs);
+      }
+      std::printf("\n  ]\n}\n");
+    }
+
+  private:
+    struct operation_state
+    {
+      size_t limbs = 0;
+      double ns = 0;
+      bool skipped = false;
+    };
+
+    sweep_options options;
+    std::vector<operation_state> states;
+    size_t current_operation = 0, current_limbs = 0;
+    bool first_result = true;
+
+    void run_size(size_t limbs)
+    {
+      current_limbs = limbs;
+      current_operation = 0;
+
+      // divisor has 'limbs' limbs, dividend twice as many
+      big_integer a = random_big(limbs), b = random_big(limbs), wide = random_big(2 * limbs);
+      big_integer_gmp ga = random_gmp(limbs), gb = random_gmp(limbs), gwide = random_gmp(2 * limbs);
+      big_integer close = a ^ big_integer(1);
+      big_integer_gmp gclose = ga ^ big_integer_gmp(1);
+      // decimal strings of the same length for both (GMP prints fast)
+      std::string str = to_string(ga), gstr = str, hex = to_string(ga, 16), ghex = hex;
+
+      operation("add", [&] { return a + b; }, [&] { return ga + gb; });
+      operation("sub", [&] { return a - b; }, [&] { return ga - gb; });
+      operation("mul", [&] { return a * b; }, [&] { return ga * gb; });
+      operation("div", [&] { return wide / b; }, [&] { return gwide / gb; });
+      operation("mod", [&] { return wide % b; }, [&] { return gwide % gb; });
+      operation("shl", [&] { return a << 37; }, [&] { return ga << 37; });
+      operation("shr", [&] { return a >> 37; }, [&] { return ga >> 37; });
+      operation("and", [&] { return a & b; }, [&] { return ga & gb; });
+      operation("or", [&] { return a | b; }, [&] { return ga | gb; });
+      operation("xor", [&] { return a ^ b; }, [&] { return ga ^ gb; });
+      operation("cmp", [&] { return a < close; }, [&] { return ga < gclose; });
+      operation("to_string", [&] { return to_string(a); }, [&] { return to_string(ga); });
+      operation("from_string", [&] { return big_integer(str); }, [&] { return big_integer_gmp(gstr); });
+      operation("to_string_hex", [&] { return to_string(a, 16); }, [&] { return to_string(ga, 16); });
+      operation("from_string_hex", [&] { return big_integer(hex, 16); }, [&] { return big_integer_gmp(ghex, 16); });
+    }
+
+    template<typename F, typename G>
+    void operation(const char *name, F f, G g)
+    {
+      if (states.size() <= current_operation)
+        states.resize(current_operation + 1);
+      operation_state &state = states[current_operation++];
+      if (state.skipped)
+        return;
+      double growth = static_cast<double>(current_limbs) / std::max(state.limbs, size_t{1});
+      if (state.limbs != 0 && state.ns * growth * growth > options.max_op_time * 1e9)
+      {
+        state.skipped = true;
+        return;
+      }
+
+      double ns = measure(f, options.min_time), gmp_ns = measure(g, options.min_time);
+      state.limbs = current_limbs;
+      state.ns = ns;
+      std::printf("%s\n    {\"operation\": \"%s\", \"limbs\": %zu, \"ns_per_op\": %.1f, "
+                  "\"gmp_ns_per_op\": %.1f, \"ratio_to_gmp\": %.3f}",
+                  first_result ? "" : ",", name, current_limbs, ns, gmp_ns, ns / gmp_ns);
+      std::fflush(stdout);
+      first_result = false;
+    }
+  };
+
+  /* Tuning tables of bigint-optimized algorithms */
+
+  // multiplication crossover: Toom-3 path (NTT disabled), automatic dispatch and GMP
+  void bench_mul_crossover()
+  {
+    using big_int_util::mul_thresholds;
+    const size_t ntt_threshold = mul_thresholds::ntt;
+    std::printf("%10s %14s %14s %14s %10s\n", "places", "no-ntt, ns", "auto, ns", "gmp, ns", "auto/gmp");
+    for (size_t places = 256; places <= (size_t{1} << 18); places *= 2)
+    {
+      big_integer a = random_big(places), b = random_big(places);
+      big_integer_gmp ga = random_gmp(places), gb = random_gmp(places);
+
+      mul_thresholds::ntt = std::numeric_limits<size_t>::max();
+      double toom = measure([&] { return a * b; });
+      mul_thresholds::ntt = ntt_threshold;
+      double dispatched = measure([&] { return a * b; });
+      double gmp = measure([&] { return ga * gb; });
+      std::printf("%10zu %14.0f %14.0f %14.0f %10.2f\n", places, toom, dispatched, gmp, dispatched / gmp);
+    }
+  }
+
+  // add/mul mix of small numbers: latency and buffer allocations (pooled and system) per operation
+  void bench_small_mix()
+  {
+    namespace pool = big_int_util::place_pool;
+    std::printf("inline capacity: %zu places of %d bits\n",
+                big_int_util::optimized_buffer::INLINE_CAPACITY, big_int_util::PLACE_BITS);
+    std::printf("%10s %12s %16s %16s\n", "bits", "ns/op", "allocations/op", "system allocs/op");
+    for (size_t bits = 128; bits <= 256; bits *= 2)
+    {
+      std::vector<big_integer> values;
+      for (int i = 0; i < 16; i++)
+        values.push_back(random_big(bits / 32) - random_big(bits / 32 - 1));
+      big_integer acc;
+      size_t ops = 0;
+      pool::reset_statistics();
+      double time = measure([&]
+        {
+          for (size_t i = 0; i < values.size(); i++)
+          {
+            const big_integer &a = values[i], &b = values[(i + 5) % values.size()];
+            // the product is truncated back to the operands size
+            acc = (a + b) * (a - b) % b + acc % a;
+          }
+          ops += 6 * values.size();
+        });
+      pool::statistics stats = pool::get_statistics();
+      std::printf("%10zu %12.1f %16.2f %16.4f\n", bits, time / (6 * values.size()),
+                  (stats.system_allocations + stats.pooled_allocations) / static_cast<double>(ops),
+                  stats.system_allocations / static_cast<double>(ops));
+    }
+  }
+
+  // steps written with operators against fused operations and expressions (big_int_util::expr)
+  void bench_fused()
+  {
+    namespace pool = big_int_util::place_pool;
+    using namespace big_int_util::expr;
+    using step = std::function<void(const big_integer &, const big_integer &)>;
+    std::printf("%10s %-22s %12s %14s %12s %14s\n",
+                "bits", "step", "ops, ns", "ops, allocs", "fused, ns", "fused, allocs");
+    for (size_t bits = 256; bits <= 4096; bits *= 16)
+    {
+      std::vector<big_integer> values;
+      for (int i = 0; i < 16; i++)
+        values.push_back(random_big(bits / 32));
+      big_integer m = random_big(bits / 64) | 1, c = random_big(bits / 32), k = 12345, acc, q, r;
+      // time and allocations of a step
+      auto run = [&](const step &f, double &allocations)
+      {
+        size_t steps = 0;
+        acc = 0;
+        pool::reset_statistics();
+        double time = measure([&]
+          {
+            for (size_t i = 0; i < values.size(); i++)
+              f(values[i], values[(i + 5) % values.size()]);
+            steps += values.size();
+          });
+        pool::statistics stats = pool::get_statistics();
+        allocations = (stats.system_allocations + stats.pooled_allocations) / static_cast<double>(steps);
+        return time / values.size();
+      };
+      auto row = [&](const char *name, const step &ops, const step &fused)
+      {
+        double ops_allocations, fused_allocations;
+        double ops_time = run(ops, ops_allocations), fused_time = run(fused, fused_allocations);
+        std::printf("%10zu %-22s %12.1f %14.2f %12.1f %14.2f\n",
+                    bits, name, ops_time, ops_allocations, fused_time, fused_allocations);
+      };
+
+      row("acc += a * 12345",
+          [&](const big_integer &a, const big_integer &) { acc += a * k; },
+          [&](const big_integer &a, const big_integer &) { addmul(acc, a, k); });
+      row("acc -= a * b",
+          [&](const big_integer &a, const big_integer &b) { acc -= a * b; },
+          [&](const big_integer &a, const big_integer &b) { submul(acc, a, b); });
+      row("r = a * 10 - b",
+          [&](const big_integer &a, const big_integer &b) { r = a * 10 - b; },
+          [&](const big_integer &a, const big_integer &b) { assign(r, lazy(a) * 10 - b); });
+      row("r = (a * b + c) % m",
+          [&](const big_integer &a, const big_integer &b) { r = (a * b + c) % m; },
+          [&](const big_integer &a, const big_integer &b) { assign(r, (lazy(a) * b + c) % m); });
+      row("r = a << 100",
+          [&](const big_integer &a, const big_integer &) { r = a << 100; },
+          [&](const big_integer &a, const big_integer &) { mul_2exp(r, a, 100); });
+      row("q = a / m, r = a % m",
+          [&](const big_integer &a, const big_integer &) { q = a / m; r = a % m; },
+          [&](const big_integer &a, const big_integer &) { divmod(q, r, a, m); });
+    }
+  }
+
+  // modular exponentiation with a full-size exponent: square-and-multiply with % (0 -- skipped), pow_mod and GMP
+  void bench_pow_mod()
+  {
+    std::printf("%10s %16s %16s %16s %16s %16s\n",
+                "bits", "naive odd, us", "odd, us", "gmp odd, us", "even, us", "gmp even, us");
+    for (size_t bits = 512; bits <= 4096; bits *= 2)
+    {
+      big_integer a = random_big(bits / 32), e = random_big(bits / 32), m = random_big(bits / 32) | 1;
+      big_integer_gmp ga(to_string(a)), ge(to_string(e)), gm(to_string(m));
+      double naive = bits > 2048 ? 0 : measure([&]
+        {
+          big_integer res = 1, power = a % m;
+          for (big_integer k = e; k != 0; k >>= 1)
+          {
+            if ((k & 1) != 0)
+              res = res * power % m;
+            power = power * power % m;
+          }
+          return res;
+        });
+      double odd = measure([&] { return pow_mod(a, e, m); });
+      double gmp_odd = measure([&] { return pow_mod(ga, ge, gm); });
+      m -= 1;
+      gm -= 1;
+      double even = measure([&] { return pow_mod(a, e, m); });
+      double gmp_even = measure([&] { return pow_mod(ga, ge, gm); });
+      std::printf("%10zu %16.0f %16.0f %16.0f %16.0f %16.0f\n",
+                  bits, naive / 1000, odd / 1000, gmp_odd / 1000, even / 1000, gmp_even / 1000);
+    }
+  }
+
+  // gcd, extended gcd and modular inverse of coprime operands against GMP
+  void bench_gcd()
+  {
+    std::printf("%10s %12s %12s %12s %12s %12s %12s\n",
+                "bits", "gcd, us", "gmp, us", "gcdext, us", "gmp, us", "inverse, us", "gmp, us");
+    for (size_t bits = 256; bits <= 16384; bits *= 4)
+    {
+      big_integer a = random_big(bits / 32), m = random_big(bits / 32) | 1;
+      while (gcd(a, m) != 1)
+        a += 1;
+      big_integer_gmp ga(to_string(a)), gm(to_string(m));
+      big_integer x, y;
+      big_integer_gmp gx, gy;
+      double gcd_time = measure([&] { return gcd(a, m); });
+      double gmp_gcd = measure([&] { return gcd(ga, gm); });
+      double ext_time = measure([&] { return extended_gcd(a, m, x, y); });
+      double gmp_ext = measure([&] { return extended_gcd(ga, gm, gx, gy); });
+      double inv_time = measure([&] { return mod_inverse(a, m); });
+      double gmp_inv = measure([&] { return mod_inverse(ga, gm); });
+      std::printf("%10zu %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f\n", bits, gcd_time / 1000, gmp_gcd / 1000,
+                  ext_time / 1000, gmp_ext / 1000, inv_time / 1000, gmp_inv / 1000);
+    }
+  }
+
+  // place-wise operations (second operand is shorter and negative to exercise sign extension)
+  void bench_bitwise()
+  {
+    std::printf("%10s %12s %12s %12s %12s %12s %12s %12s\n",
+                "places", "&, ns", "|, ns", "^, ns", "~, ns", "+, ns", "<< 33, ns", ">>= 1, ns");
+    for (size_t places = 4; places <= (size_t{1} << 16); places *= 8)
+    {
+      big_integer a = random_big(places), b = -random_big(places / 2 + 1);
+      double and_time = measure([&] { return a & b; });
+      double or_time = measure([&] { return a | b; });
+      double xor_time = measure([&] { return a ^ b; });
+      double not_time = measure([&] { return ~a; });
+      double add_time = measure([&] { return a + b; });
+      double shl_time = measure([&] { return a << 33; });
+      // c is drained by the shifts, so it is refilled (with a unique buffer) every 32 of them
+      big_integer c;
+      double shr_time = measure_prepared([&] { c = a << 1; }, [&] { return c >>= 1; }, 32);
+      std::printf("%10zu %12.0f %12.0f %12.0f %12.0f %12.0f %12.0f %12.0f\n",
+                  places, and_time, or_time, xor_time, not_time, add_time, shl_time, shr_time);
+    }
+  }
+
+  // parallel execution: NTT and Toom-3 (NTT disabled) products and decimal conversion by number of threads
+  void bench_parallel_scaling()
+  {
+    using big_int_util::mul_thresholds;
+    const size_t ntt_threshold = mul_thresholds::ntt;
+    const size_t places = size_t{1} << 16;
+    big_integer a = random_big(places), b = random_big(places);
+    std::printf("%zu places, hardware concurrency: %u\n", places, std::thread::hardware_concurrency());
+    std::printf("%8s %12s %8s %12s %8s %14s %8s\n",
+                "threads", "ntt, ms", "speedup", "toom3, ms", "speedup", "to_string, ms", "speedup");
+    double base[3] = {0, 0, 0};
+    for (size_t threads = 1; threads <= 32; threads *= 2)
+    {
+      big_int_util::set_parallel_threads(threads);
+      double ntt = measure([&] { return a * b; });
+      mul_thresholds::ntt = std::numeric_limits<size_t>::max();
+      double toom = measure([&] { return a * b; });
+      mul_thresholds::ntt = ntt_threshold;
+      double conv = measure([&] { return to_string(a); });
+      if (threads == 1)
+      {
+        base[0] = ntt;
+        base[1] = toom;
+        base[2] = conv;
+      }
+      std::printf("%8zu %12.1f %8.2f %12.1f %8.2f %14.1f %8.2f\n", threads, ntt / 1e6, base[0] / ntt,
+                  toom / 1e6, base[1] / toom, conv / 1e6, base[2] / conv);
+    }
+    big_int_util::set_parallel_threads(1);
+  }
+}
+
+// usage: big_integer_bench [--max-limbs N] [--min-time S] [--max-op-time S] [--tuning] [--scaling]
+// prints JSON results of the sweep, tuning tables with --tuning, or parallel scaling with --scaling
+int main(int argc, char *argv[])
+{
+  sweep_options options;
+  bool tuning = false, scaling = false;
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "--tuning") == 0)
+      tuning = true;
+    else if (std::strcmp(argv[i], "--scaling") == 0)
+      scaling = true;
+    else if (std::strcmp(argv[i], "--max-limbs") == 0 && i + 1 < argc)
+      options.max_limbs = std::strtoul(argv[++i], nullptr, 10);
+    else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+      options.min_time = std::strtod(argv[++i], nullptr);
+    else if (std::strcmp(argv[i], "--max-op-time") == 0 && i + 1 < argc)
+      options.max_op_time = std::strtod(argv[++i], nullptr);
+    else
+    {
+      std::fprintf(stderr, "usage: %s [--max-limbs N] [--min-time S] [--max-op-time S] [--tuning] [--scaling]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  if (scaling)
+    bench_parallel_scaling();
+  else if (tuning)
+  {
+    bench_mul_crossover();
+    bench_bitwise();
+    bench_small_mix();
+    bench_fused();
+    bench_pow_mod();
+    bench_gcd();
+  }
+  else
+    sweep(options).run("bigint-optimized", big_int_util::PLACE_BITS);
+}
@@ -15,8 +15,8 @@ big_integer_gmp::big_integer_gmp(int a) {
   mpz_init_set_si(mpz, a);
 }
 
-big_integer_gmp::big_integer_gmp(std::string const& str) {
-  if (mpz_init_set_str(mpz, str.c_str(), 10)) {
+big_integer_gmp::big_integer_gmp(std::string const& str, int base) {
+  if (mpz_init_set_str(mpz, str.c_str(), base)) {
     mpz_clear(mpz);
     throw std::runtime_error("invalid string");
   }
@@ -183,8 +183,50 @@ bool operator>=(big_integer_gmp const& a, big_integer_gmp const& b) {
   return mpz_cmp(a.mpz, b.mpz) >= 0;
 }
 
-std::string to_string(big_integer_gmp const& a) {
-  char* tmp = mpz_get_str(NULL, 10, a.mpz);
+big_integer_gmp pow_mod(big_integer_gmp const& base, big_integer_gmp const& exp, big_integer_gmp const& mod) {
+  big_integer_gmp r;
+  mpz_powm(r.mpz, base.mpz, exp.mpz, mod.mpz);
+  return r;
+}
+
+big_integer_gmp gcd(big_integer_gmp const& a, big_integer_gmp const& b) {
+  big_integer_gmp r;
+  mpz_gcd(r.mpz, a.mpz, b.mpz);
+  return r;
+}
+
+big_integer_gmp extended_gcd(big_integer_gmp const& a, big_integer_gmp const& b, big_integer_gmp& x, big_integer_gmp& y) {
+  big_integer_gmp r;
+  mpz_gcdext(r.mpz, x.mpz, y.mpz, a.mpz, b.mpz);
+  return r;
+}
+
+big_integer_gmp mod_inverse(big_integer_gmp const& a, big_integer_gmp const& mod) {
+  big_integer_gmp r;
+  if (mpz_sgn(mod.mpz) == 0 || !mpz_invert(r.mpz, a.mpz, mod.mpz)) {
+    throw std::invalid_argument("not invertible");
+  }
+  return r;
+}
+
+big_integer_gmp isqrt(big_integer_gmp const& n) {
+  big_integer_gmp r;
+  mpz_sqrt(r.mpz, n.mpz);
+  return r;
+}
+
+big_integer_gmp iroot(big_integer_gmp const& n, int k) {
+  big_integer_gmp r;
+  mpz_root(r.mpz, n.mpz, k);
+  return r;
+}
+
+bool is_perfect_power(big_integer_gmp const& n) {
+  return mpz_perfect_power_p(n.mpz) != 0;
+}
+
+std::string to_string(big_integer_gmp const& a, int base) {
+  char* tmp = mpz_get_str(NULL, base, a.mpz);
   std::string res = tmp;
 
   void (* freefunc)(void*, size_t);
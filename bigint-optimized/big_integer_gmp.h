@@ -9,7 +9,7 @@ struct big_integer_gmp {
   big_integer_gmp();
   big_integer_gmp(big_integer_gmp const& other);
   big_integer_gmp(int a);
-  explicit big_integer_gmp(std::string const& str);
+  explicit big_integer_gmp(std::string const& str, int base = 10);
 
   template<typename RNG>
   big_integer_gmp& random(size_t sz, RNG&& rng) {
@@ -58,7 +58,21 @@ struct big_integer_gmp {
   friend bool operator<=(big_integer_gmp const& a, big_integer_gmp const& b);
   friend bool operator>=(big_integer_gmp const& a, big_integer_gmp const& b);
 
-  friend std::string to_string(big_integer_gmp const& a);
+  friend big_integer_gmp pow_mod(big_integer_gmp const& base, big_integer_gmp const& exp,
+                                 big_integer_gmp const& mod);
+
+  friend big_integer_gmp gcd(big_integer_gmp const& a, big_integer_gmp const& b);
+  friend big_integer_gmp extended_gcd(big_integer_gmp const& a, big_integer_gmp const& b,
+                                      big_integer_gmp& x, big_integer_gmp& y);
+  friend big_integer_gmp mod_inverse(big_integer_gmp const& a, big_integer_gmp const& mod);
+big_integer_gmp isqrt(big_integer_gmp const& n);
+big_integer_gmp iroot(big_integer_gmp const& n, int k);
+bool is_perfect_power(big_integer_gmp const& n);
+  friend big_integer_gmp isqrt(big_integer_gmp const& n);
+  friend big_integer_gmp iroot(big_integer_gmp const& n, int k);
+  friend bool is_perfect_power(big_integer_gmp const& n);
+
+  friend std::string to_string(big_integer_gmp const& a, int base);
 
  private:
   mpz_t mpz;
@@ -84,7 +98,15 @@ bool operator>(big_integer_gmp const& a, big_integer_gmp const& b);
 bool operator<=(big_integer_gmp const& a, big_integer_gmp const& b);
 bool operator>=(big_integer_gmp const& a, big_integer_gmp const& b);
 
-std::string to_string(big_integer_gmp const& a);
+big_integer_gmp pow_mod(big_integer_gmp const& base, big_integer_gmp const& exp, big_integer_gmp const& mod);
+big_integer_gmp gcd(big_integer_gmp const& a, big_integer_gmp const& b);
+big_integer_gmp extended_gcd(big_integer_gmp const& a, big_integer_gmp const& b, big_integer_gmp& x, big_integer_gmp& y);
+big_integer_gmp mod_inverse(big_integer_gmp const& a, big_integer_gmp const& mod);
+big_integer_gmp isqrt(big_integer_gmp const& n);
+big_integer_gmp iroot(big_integer_gmp const& n, int k);
+bool is_perfect_power(big_integer_gmp const& n);
+
+std::string to_string(big_integer_gmp const& a, int base = 10);
 std::ostream& operator<<(std::ostream& s, big_integer_gmp const& a);
 
 #endif // BIG_INTEGER_GMP_H
\ No newline at end of file
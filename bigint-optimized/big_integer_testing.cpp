@@ -2,12 +2,23 @@
 #include <cassert>
 #include <cstdlib>
 #include <random>
+#ifdef BIGINT_ATOMIC_REFCOUNT
+#include <thread>
+#endif
+#include <unordered_map>
 #include <vector>
 #include <utility>
 #include <gtest/gtest.h>
 
 #include "big_integer.h"
 #include "big_integer_gmp.h"
+#include "multiplication.h"
+#include "division.h"
+#include "conversion.h"
+#include "expression.h"
+#include "fixed_integer.h"
+#include "parallel.h"
+#include "place_pool.h"
 
 TEST(correctness, two_plus_two) {
   EXPECT_EQ(big_integer(4), big_integer(2) + big_integer(2));
@@ -76,6 +87,139 @@ TEST(correctness, assignment_return_value) {
   EXPECT_TRUE(b == 7);
 }
 
+TEST(correctness, move_ctor_and_assignment) {
+  big_integer a("123456789012345678901234567890");
+  big_integer b = std::move(a);
+  EXPECT_EQ(big_integer("123456789012345678901234567890"), b);
+  EXPECT_EQ(0, a);
+
+  big_integer c = 5;
+  c = std::move(b);
+  EXPECT_EQ(big_integer("123456789012345678901234567890"), c);
+  a = 7;
+  EXPECT_EQ(7, a + 0);
+}
+
+TEST(correctness, rvalue_operators) {
+  big_integer a("-98765432109876543210987654321"), b("12345678901234567890"), c(3);
+
+  EXPECT_EQ(a * b + c, (a * b) + (c * 1));
+  EXPECT_EQ(c + a * b, (c * 1) + (a * b));
+  EXPECT_EQ(b * (a + c) + c * (a - b), (a + 0) * (c + b));
+  EXPECT_EQ(a & b, (a + 0) & (b * 1));
+  EXPECT_EQ(a | b, a | (b * 1));
+  EXPECT_EQ(a ^ b, (b * 1) ^ (a + 0));
+  EXPECT_EQ(big_integer("-98765432109876543210987654318"), a + 3);
+}
+
+TEST(correctness, place_pool_reuse) {
+  namespace pool = big_int_util::place_pool;
+  big_integer a = big_integer(1) << 1000;
+  pool::reset_statistics();
+  for (int i = 0; i < 100; i++)
+  {
+    big_integer b = a + i;
+    EXPECT_EQ(i, b - a);
+  }
+  pool::statistics stats = pool::get_statistics();
+  EXPECT_LE(stats.system_allocations, 4u);
+  EXPECT_GE(stats.pooled_allocations, 100u);
+}
+
+TEST(correctness, scoped_arena) {
+  namespace pool = big_int_util::place_pool;
+  big_integer kept;
+  {
+    big_int_util::scoped_arena arena;
+    std::vector<big_integer> temporaries;
+    for (int i = 0; i < 200; i++)
+      temporaries.push_back(big_integer(i + 1) << 1000);
+    kept = temporaries.back() + 1;
+    temporaries.clear();
+    // all freed blocks are cached while the arena is alive
+    EXPECT_GE(pool::get_statistics().cached_blocks, 200u);
+  }
+  EXPECT_EQ(0u, pool::get_statistics().cached_blocks);
+  EXPECT_EQ((big_integer(200) << 1000) + 1, kept);
+}
+
+#ifdef BIGINT_INSTRUMENTATION
+TEST(correctness, instrumentation_counters) {
+  namespace inst = big_int_util::instrumentation;
+  big_integer a = big_integer(1) << 1000, b = a + 1;
+  inst::reset();
+  big_integer c = a;  // shares places with a
+  c += 1;             // copies them before the write
+  c *= b;
+  c /= a;
+  inst::counters counters = inst::snapshot();
+
+  EXPECT_EQ(b + 1, c);
+  EXPECT_EQ(1u, counters.cow_copies);
+  size_t adds = 0, muls = 0, divs = 0, allocations = 0;
+  for (size_t i = 0; i < inst::SIZE_BUCKETS; i++)
+  {
+    adds += counters.operations[inst::op_add][i];
+    muls += counters.operations[inst::op_mul][i];
+    divs += counters.operations[inst::op_div][i];
+    allocations += counters.allocations[i];
+  }
+  EXPECT_EQ(1u, adds);
+  EXPECT_EQ(1u, muls);
+  EXPECT_EQ(1u, divs);
+  EXPECT_GE(allocations, 3u);
+  EXPECT_EQ(allocations, counters.pool.system_allocations + counters.pool.pooled_allocations);
+
+  inst::reset();
+  EXPECT_EQ(0u, inst::snapshot().cow_copies);
+  EXPECT_EQ(0u, inst::snapshot().pool.system_allocations);
+}
+#endif
+
+#ifdef BIGINT_ASM_LIMBS
+TEST(correctness, asm_limb_kernels) {
+  // every implementation of the dispatched kernels gives the same places, also in place
+  std::mt19937_64 rng(7);
+  uint64_t features = asm_cpu_features();
+  for (size_t n = 0; n < 40; n++)
+  {
+    std::vector<uint64_t> a(n), r(n);
+    for (uint64_t &x : a)
+      x = rng() % 3 == 0 ? ~uint64_t{0} : rng();
+    uint64_t b = rng() | uint64_t{1} << 63;
+
+    std::vector<uint64_t> expected = a;
+    uint64_t high = asm_mul_long_short_mul(expected.data(), expected.data(), n, b);
+    r = a;
+    EXPECT_EQ(high, asm_mul_long_short(r.data(), r.data(), n, b));
+    EXPECT_EQ(expected, r);
+    if (features & ASM_CPU_BMI2)
+    {
+      r = a;
+      EXPECT_EQ(high, asm_mul_long_short_mulx(r.data(), r.data(), n, b));
+      EXPECT_EQ(expected, r);
+    }
+
+    expected = a;
+    high = asm_add_long_mul_long_short_mul(expected.data(), a.data(), n, b);
+    r = a;
+    EXPECT_EQ(high, asm_add_long_mul_long_short(r.data(), a.data(), n, b));
+    EXPECT_EQ(expected, r);
+    if ((features & (ASM_CPU_BMI2 | ASM_CPU_ADX)) == (ASM_CPU_BMI2 | ASM_CPU_ADX))
+    {
+      r = a;
+      EXPECT_EQ(high, asm_add_long_mul_long_short_adx(r.data(), a.data(), n, b));
+      EXPECT_EQ(expected, r);
+    }
+
+    expected = a;
+    uint64_t remainder = big_int_util::div_1(expected.data(), a.data(), n, b);
+    EXPECT_EQ(remainder, asm_div_long_short(r.data(), a.data(), n, b));
+    EXPECT_EQ(expected, r);
+  }
+}
+#endif
+
 TEST(correctness, comparisons) {
   big_integer a = 100;
   big_integer b = 100;
@@ -273,6 +417,16 @@ TEST(correctness, negation_int_min) {
   EXPECT_EQ(b - 1, std::numeric_limits<int>::max());
 }
 
+TEST(correctness, negation_place_boundaries) {
+  big_integer a = big_integer(1) << 63, b = big_integer(1) << 64;
+
+  EXPECT_EQ(a, -(-a));
+  EXPECT_EQ(big_integer("-9223372036854775808"), -a);
+  EXPECT_EQ(big_integer("18446744073709551616"), -(-b));
+  EXPECT_EQ(a - 1, -(1 - a));
+  EXPECT_EQ(0, -(a - a));
+}
+
 TEST(correctness, and_) {
   big_integer a = 0x55;
   big_integer b = 0xaa;
@@ -517,6 +671,28 @@ TEST(correctness, negation_long) {
   EXPECT_EQ(-c, a);
 }
 
+TEST(correctness, shifts_place_boundaries) {
+  big_integer a("-340282366920938463463374607431768211456"); // -2^128
+  big_integer b("123456789012345678901234567890");
+
+  EXPECT_EQ(b, b << 0);
+  EXPECT_EQ(b, b >> 0);
+  EXPECT_EQ(b, (b << 64) >> 64);
+  EXPECT_EQ(b, (b << 95) >> 95);
+  EXPECT_EQ(a, big_integer(-1) << 128);
+  EXPECT_EQ(-1, a >> 128);
+  EXPECT_EQ(-1, a >> 1000);
+  EXPECT_EQ(0, b >> 1000);
+  EXPECT_EQ(-1, a >> std::numeric_limits<int>::max());
+  EXPECT_EQ(big_integer(-2) << 127, a);
+  EXPECT_EQ(big_integer("-170141183460469231731687303715884105728"), a >> 1);
+
+  big_integer c = b;
+  c <<= 33;
+  c >>= 33;
+  EXPECT_EQ(b, c);
+}
+
 TEST(correctness, shl_long) {
   EXPECT_EQ(big_integer("1091951238831590836520041079875950759639875963123939936"),
             big_integer("34123476213487213641251283746123461238746123847623123") << 5);
@@ -557,6 +733,338 @@ TEST(correctness, string_conv) {
   EXPECT_EQ("-2147483649", to_string(lim));
 }
 
+TEST(correctness, string_conv_bases) {
+  EXPECT_EQ("ff", to_string(big_integer(255), 16));
+  EXPECT_EQ("-11111111", to_string(big_integer(-255), 2));
+  EXPECT_EQ("377", to_string(big_integer(255), 8));
+  EXPECT_EQ("7v", to_string(big_integer(255), 32));
+  EXPECT_EQ("73", to_string(big_integer(255), 36));
+  EXPECT_EQ("100110", to_string(big_integer(255), 3));
+  EXPECT_EQ("0", to_string(big_integer(0), 16));
+  EXPECT_EQ("1" + std::string(50, '0'), to_string(big_integer(1) << 200, 16));
+  EXPECT_EQ(big_integer(1) << 200, big_integer("1" + std::string(50, '0'), 16));
+  EXPECT_EQ(big_integer(-0xabcdef), big_integer("-AbCdEf", 16));
+  EXPECT_EQ(big_integer(35), big_integer("z", 36));
+  EXPECT_THROW(big_integer("12", 2), std::runtime_error);
+  EXPECT_THROW(big_integer("12", 1), std::invalid_argument);
+  EXPECT_THROW(to_string(big_integer(12), 37), std::invalid_argument);
+
+  std::string str = "7fg";
+  big_integer a;
+  from_chars_result fr = from_chars(str.data(), str.data() + str.size(), a, 16);
+  EXPECT_EQ(str.data() + 2, fr.ptr);
+  EXPECT_EQ(127, a);
+}
+
+TEST(correctness, chars_conv) {
+  char buf[32];
+  big_integer a("-12345678901234567890");
+  to_chars_result tr = to_chars(buf, buf + sizeof(buf), a);
+  EXPECT_EQ(std::errc(), tr.ec);
+  EXPECT_EQ("-12345678901234567890", std::string(buf, tr.ptr));
+
+  // exact fit and too small buffer
+  tr = to_chars(buf, buf + 21, a);
+  EXPECT_EQ(std::errc(), tr.ec);
+  EXPECT_EQ(buf + 21, tr.ptr);
+  tr = to_chars(buf, buf + 20, a);
+  EXPECT_EQ(std::errc::value_too_large, tr.ec);
+  EXPECT_EQ(buf + 20, tr.ptr);
+
+  std::string str = "-0042tail";
+  big_integer b;
+  from_chars_result fr = from_chars(str.data(), str.data() + str.size(), b);
+  EXPECT_EQ(std::errc(), fr.ec);
+  EXPECT_EQ(str.data() + 5, fr.ptr);
+  EXPECT_EQ(-42, b);
+
+  str = "-x";
+  fr = from_chars(str.data(), str.data() + str.size(), b);
+  EXPECT_EQ(std::errc::invalid_argument, fr.ec);
+  EXPECT_EQ(str.data(), fr.ptr);
+  EXPECT_EQ(-42, b);
+
+  EXPECT_THROW(big_integer("12a"), std::runtime_error);
+  EXPECT_THROW(big_integer("-"), std::runtime_error);
+  EXPECT_THROW(big_integer(""), std::runtime_error);
+}
+
+TEST(correctness, pow_mod) {
+  EXPECT_EQ(big_integer(445), pow_mod(big_integer(4), 13, 497));
+  EXPECT_EQ(big_integer(49), pow_mod(big_integer(7), 222, 1000));
+  EXPECT_EQ(big_integer(1), pow_mod(big_integer(12345), 0, 7));
+  EXPECT_EQ(big_integer(0), pow_mod(big_integer(12345), 0, 1));
+  EXPECT_EQ(big_integer(0), pow_mod(big_integer(0), 5, 12));
+  // result is in [0, |mod|)
+  EXPECT_EQ(big_integer(3), pow_mod(big_integer(-2), 3, 11));
+  EXPECT_EQ(big_integer(3), pow_mod(big_integer(-2), 3, -11));
+  // Fermat's little theorem with prime 2^127 - 1
+  big_integer p = (big_integer(1) << 127) - 1;
+  EXPECT_EQ(big_integer(1), pow_mod(big_integer("123456789123456789"), p - 1, p));
+  // modulus B^k (even, Barrett's mu does not fit into k + 1 places)
+  big_integer b = big_integer(1) << 64;
+  big_integer power = 1;
+  for (int i = 0; i != 80; ++i)
+    power = power * 3 % b;
+  EXPECT_EQ(power, pow_mod(big_integer(3), 80, b));
+  EXPECT_THROW(pow_mod(big_integer(2), -1, 7), std::invalid_argument);
+  EXPECT_THROW(pow_mod(big_integer(2), 3, 0), std::invalid_argument);
+}
+
+TEST(correctness, gcd) {
+  EXPECT_EQ(big_integer(6), gcd(big_integer(48), 18));
+  EXPECT_EQ(big_integer(6), gcd(big_integer(-48), -18));
+  EXPECT_EQ(big_integer(7), gcd(big_integer(0), -7));
+  EXPECT_EQ(big_integer(0), gcd(big_integer(0), 0));
+  EXPECT_EQ(big_integer(1), gcd(big_integer(1) << 200, (big_integer(1) << 127) - 1));
+  EXPECT_EQ(big_integer(1) << 100, gcd(big_integer(3) << 200, big_integer(5) << 100));
+
+  big_integer x, y;
+  EXPECT_EQ(big_integer(2), extended_gcd(big_integer(240), 46, x, y));
+  EXPECT_EQ(big_integer(2), x * 240 + y * 46);
+  EXPECT_EQ(big_integer(5), extended_gcd(big_integer(-5), 0, x, y));
+  EXPECT_EQ(big_integer(-1), x);
+  EXPECT_EQ(big_integer(0), y);
+  // outputs may alias operands
+  x = 35;
+  y = -15;
+  EXPECT_EQ(big_integer(5), extended_gcd(x, y, x, y));
+  EXPECT_EQ(big_integer(5), x * 35 - y * 15);
+
+  EXPECT_EQ(big_integer(4), mod_inverse(big_integer(3), 11));
+  EXPECT_EQ(big_integer(7), mod_inverse(big_integer(-3), -11));
+  EXPECT_EQ(big_integer(0), mod_inverse(big_integer(5), 1));
+  EXPECT_THROW(mod_inverse(big_integer(6), 9), std::invalid_argument);
+  EXPECT_THROW(mod_inverse(big_integer(6), 0), std::invalid_argument);
+}
+
+TEST(correctness, roots) {
+  EXPECT_EQ(big_integer(0), isqrt(big_integer(0)));
+  EXPECT_EQ(big_integer(3), isqrt(big_integer(15)));
+  EXPECT_EQ(big_integer(4), isqrt(big_integer(16)));
+  EXPECT_EQ(big_integer(1) << 100, isqrt(big_integer(1) << 200));
+  EXPECT_EQ((big_integer(1) << 100) - 1, isqrt((big_integer(1) << 200) - 1));
+  EXPECT_EQ(big_integer(-3), iroot(big_integer(-27), 3));
+  EXPECT_EQ(big_integer(-2), iroot(big_integer(-26), 3));
+  EXPECT_EQ(big_integer(12345), iroot(big_integer(12345), 1));
+  EXPECT_EQ(big_integer(1), iroot(big_integer(1) << 100, 101));
+  big_integer pow3 = 1;
+  for (int i = 0; i != 70; ++i)
+    pow3 *= 3;
+  EXPECT_EQ(big_integer(3), iroot(pow3, 70));
+  EXPECT_EQ(big_integer(2), iroot(pow3 - 1, 70));
+  EXPECT_THROW(isqrt(big_integer(-1)), std::invalid_argument);
+  EXPECT_THROW(iroot(big_integer(-1), 4), std::invalid_argument);
+  EXPECT_THROW(iroot(big_integer(5), 0), std::invalid_argument);
+
+  EXPECT_TRUE(is_perfect_power(big_integer(0)));
+  EXPECT_TRUE(is_perfect_power(big_integer(-1)));
+  EXPECT_TRUE(is_perfect_power(big_integer(-8)));
+  EXPECT_FALSE(is_perfect_power(big_integer(-4)));
+  EXPECT_FALSE(is_perfect_power(big_integer(2)));
+  EXPECT_TRUE(is_perfect_power(big_integer(1) << 77));
+  EXPECT_FALSE(is_perfect_power((big_integer(1) << 77) * 3));
+  big_integer p = (big_integer(1) << 61) - 1;
+  EXPECT_TRUE(is_perfect_power(p * p * p * p * p * p * p));
+  EXPECT_FALSE(is_perfect_power(p * p * p * p * p * p * p + 1));
+  EXPECT_TRUE(is_perfect_power(p * p * p * 125 << 3));
+}
+
+TEST(correctness, export_import_bytes) {
+  using bytes = std::vector<unsigned char>;
+  EXPECT_EQ(bytes({0x00}), export_bytes(big_integer(0)));
+  EXPECT_EQ(bytes({0xff}), export_bytes(big_integer(-1)));
+  EXPECT_EQ(bytes({0x80}), export_bytes(big_integer(-128)));
+  EXPECT_EQ(bytes({0x80, 0x00}), export_bytes(big_integer(128)));
+  EXPECT_EQ(bytes({0x00, 0x80}), export_bytes(big_integer(128), byte_order::big_endian));
+  EXPECT_EQ(bytes({0x12, 0x34, 0x56}), export_bytes(big_integer(0x123456), byte_order::big_endian));
+  EXPECT_EQ(bytes({0x81}), export_bytes(big_integer(-1), byte_order::little_endian, sign_encoding::sign_magnitude));
+  EXPECT_EQ(bytes({0x80, 0x80}),
+            export_bytes(big_integer(-128), byte_order::big_endian, sign_encoding::sign_magnitude));
+  EXPECT_EQ(2u, export_bytes_length(big_integer(-128), sign_encoding::sign_magnitude));
+  EXPECT_EQ(9u, export_bytes_length(big_integer(1) << 64));
+  EXPECT_EQ(8u, export_bytes_length(-(big_integer(1) << 63)));
+
+  unsigned char const twos[] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff};
+  EXPECT_EQ(-(big_integer(1) << 64), import_bytes(twos, 9));
+  EXPECT_EQ(big_integer(255), import_bytes(twos, 9, byte_order::big_endian));
+  EXPECT_EQ(-(big_integer(0x7f) << 64), import_bytes(twos, 9, byte_order::little_endian, sign_encoding::sign_magnitude));
+  EXPECT_EQ(big_integer(0), import_bytes(twos, 0));
+  unsigned char const minus_zero[] = {0x80, 0x00};
+  EXPECT_EQ(big_integer(0), import_bytes(minus_zero, 2, byte_order::big_endian, sign_encoding::sign_magnitude));
+}
+
+TEST(correctness, hash) {
+  std::hash<big_integer> h;
+  big_integer a = (big_integer(1) << 300) - 12345;
+  big_integer b = big_integer(to_string(a));
+  // equal numbers of different history have the same hash
+  EXPECT_EQ(h(a), h(b));
+  EXPECT_EQ(h(a), h(((a << 64) + 1) >> 64));
+  EXPECT_EQ(h(big_integer(-1)), h(big_integer(0) - 1));
+  EXPECT_NE(h(a), h(a + 1));
+  EXPECT_NE(h(a), h(-a));
+
+  // a cached hash is not kept after modification in place
+  big_integer c = a;
+  EXPECT_EQ(h(a), h(c));
+  c += 1;
+  EXPECT_EQ(h(a + 1), h(c));
+  c -= 1;
+  EXPECT_EQ(h(a), h(c));
+  c >>= 200;
+  EXPECT_EQ(h(a >> 200), h(c));
+
+  std::unordered_map<big_integer, int> map;
+  for (int i = 0; i != 1000; ++i)
+    map[(big_integer(i) << 100) - i] = i;
+  EXPECT_EQ(1000u, map.size());
+  for (int i = 0; i != 1000; ++i)
+    EXPECT_EQ(i, map[(big_integer(i) << 100) - i]);
+}
+
+TEST(correctness, adopted_places) {
+  std::vector<big_int_util::place_t> places = {5, 0, 0};
+  big_integer a(place_view{places.data(), places.size()});
+  EXPECT_EQ(big_integer(5), a);
+  EXPECT_EQ(places.data(), a.places().data);
+  EXPECT_EQ(1u, a.places().size);
+
+  // copies share adopted places, modification makes its own ones
+  big_integer b = a;
+  EXPECT_EQ(places.data(), b.places().data);
+  b += 1;
+  EXPECT_EQ(big_integer(6), b);
+  EXPECT_EQ(big_integer(5), a);
+  EXPECT_EQ(5u, places[0]);
+  b = a << 100;
+  EXPECT_EQ(big_integer(5), b >> 100);
+  std::swap(a, b);
+  EXPECT_EQ(big_integer(5), b);
+  EXPECT_EQ(places.data(), b.places().data);
+
+  // view of a number is adopted by another one
+  big_integer c = -(big_integer(1) << 200) + 1;
+  big_integer d(c.places());
+  EXPECT_EQ(c, d);
+  EXPECT_EQ(c.places().data, d.places().data);
+  EXPECT_EQ(big_integer(0), big_integer(place_view{nullptr, 0}));
+}
+
+TEST(correctness, fused_operations) {
+  // factors of a single place at place boundaries, and ones which do not fit
+  std::vector<std::string> values = {"0", "1", "-1", "-5", "2147483647", "-2147483648", "4294967295",
+                                     "-4294967295", "-4294967296", "9223372036854775808",
+                                     "-18446744073709551615", "18446744073709551616",
+                                     "-1606938044258990275541962092341162602522202993782792835301376",
+                                     "1606938044258990275541962092341162602522202993782792835301375"};
+  for (std::string const& x : values)
+    for (std::string const& y : values) {
+      big_integer_gmp gx(x), gy(y), gc("-123456789012345678901234567890");
+      big_integer X(x), Y(y), R("-123456789012345678901234567890");
+      addmul(R, X, Y);
+      EXPECT_EQ(to_string(gc + gx * gy), to_string(R));
+      submul(R, Y, X);
+      EXPECT_EQ(to_string(gc), to_string(R));
+      X *= Y;
+      EXPECT_EQ(to_string(gx * gy), to_string(X));
+      mul(R, Y, Y);
+      EXPECT_EQ(to_string(gy * gy), to_string(R));
+    }
+
+  // the destination may be an operand
+  big_integer a = (big_integer(1) << 200) - 7, b(-12345), x = a;
+  addmul(x, x, x);
+  EXPECT_EQ(a + a * a, x);
+  x = -a;
+  submul(x, b, x);
+  EXPECT_EQ(-a + a * b, x);
+  x = a;
+  mul(x, b, x);
+  EXPECT_EQ(a * b, x);
+
+  for (int bits : {0, 1, 31, 32, 64, 100}) {
+    mul_2exp(x, a, bits);
+    EXPECT_EQ(a << bits, x);
+    mul_2exp(x, b, bits);
+    EXPECT_EQ(b << bits, x);
+  }
+  mul_2exp(x, b, -3);
+  EXPECT_EQ(b >> 3, x);
+  mul_2exp(x, x, 70);
+  EXPECT_EQ((b >> 3) << 70, x);
+
+  big_integer q, r;
+  divmod(q, r, -a, b);
+  EXPECT_EQ(-a / b, q);
+  EXPECT_EQ(-a % b, r);
+  q = a;
+  r = b;
+  divmod(q, r, q, r);
+  EXPECT_EQ(a / b, q);
+  EXPECT_EQ(a % b, r);
+  q = b;
+  divmod(q, r, a, q);
+  EXPECT_EQ(a / b, q);
+  EXPECT_EQ(a % b, r);
+  EXPECT_THROW(divmod(q, q, a, b), std::invalid_argument);
+
+  using namespace big_int_util::expr;
+  big_integer c(777), m = (big_integer(1) << 100) + 1;
+  big_integer e = (lazy(a) * b + c) % m;
+  EXPECT_EQ((a * b + c) % m, e);
+  assign(e, lazy(a) * b - lazy(c) * 3 + 5 - a);
+  EXPECT_EQ(a * b - c * 3 + 5 - a, e);
+  add_assign(e, lazy(a) * (lazy(b) + c) - (lazy(a) << 3));
+  EXPECT_EQ(a * b - c * 3 + 5 - a + a * (b + c) - (a << 3), e);
+  sub_assign(e, lazy(e) * 2);
+  EXPECT_EQ(-(a * b - c * 3 + 5 - a + a * (b + c) - (a << 3)), e);
+  assign(e, (lazy(a) + 1) * e % m);
+  EXPECT_EQ((a + 1) * -(a * b - c * 3 + 5 - a + a * (b + c) - (a << 3)) % m, e);
+}
+
+TEST(correctness, fixed_integer) {
+  using int256 = fixed_integer<256>;
+  using uint256 = fixed_integer<256, false>;
+  int256 min = int256(1) << 255, max = min - 1;
+  EXPECT_EQ(-(big_integer(1) << 255), big_integer(min));
+  EXPECT_EQ((big_integer(1) << 255) - 1, big_integer(max));
+  EXPECT_EQ(min, max + 1);
+  EXPECT_EQ(min, -min);
+  EXPECT_EQ(min, min / -1);
+  EXPECT_EQ(int256(0), min % -1);
+  EXPECT_LT(min, max);
+  EXPECT_EQ(int256(-1), min >> 300);
+  EXPECT_EQ(int256(0), max << 256);
+
+  uint256 umax = uint256(0) - 1;
+  EXPECT_EQ((big_integer(1) << 256) - 1, big_integer(umax));
+  EXPECT_EQ(uint256(0), umax + 1);
+  EXPECT_GT(umax, uint256(min));
+  EXPECT_EQ(uint256(1), umax >> 255);
+  EXPECT_EQ(int256(-1), int256(umax));
+
+  // spare bits of the last place wrap as well
+  using int100 = fixed_integer<100>;
+  EXPECT_EQ(-(big_integer(1) << 99), big_integer(int100(1) << 99));
+  EXPECT_EQ(int100(-1), int100(big_integer(1) << 100) - 1);
+  EXPECT_EQ(int100(1) << 99, (int100(1) << 99) / -1);
+  EXPECT_EQ(big_integer(-3), big_integer(fixed_integer<2000>(int100(-3))));
+  EXPECT_EQ(big_integer("-9223372036854775808"), big_integer(int100(INT64_MIN)));
+  EXPECT_EQ(big_integer("18446744073709551615"), big_integer(int100(UINT64_MAX)));
+  EXPECT_EQ(big_integer(5), big_integer(fixed_integer<3, false>(13)));
+  EXPECT_EQ(big_integer(-3), big_integer(fixed_integer<3>(13)));
+  EXPECT_EQ("-3", to_string(fixed_integer<3>(9) * 7 - 2));
+  EXPECT_THROW(int256(1) / 0, std::invalid_argument);
+
+#if __cplusplus >= 201703L
+  constexpr int256 n = -(int256(12345) << 200) - 678, d = int256(12345) << 100;
+  static_assert(n / d == -(int256(1) << 100) && n % d == -678, "constexpr arithmetic");
+  static_assert((int256(-7) / 2 == -3) && (int256(-7) % 2 == -1) && (uint256(7) >> 1) == 3, "constexpr division");
+  static_assert(~int256(0) == -1 && (uint256(1) << 255) > uint256(1), "constexpr bitwise");
+#endif
+}
+
 namespace {
 size_t const number_of_iterations = 10;
 size_t const max_size = 2048;
@@ -724,6 +1232,37 @@ TEST(correctness_random, mul) {
   }
 }
 
+TEST(correctness_random, mul_algorithms) {
+  // lower thresholds to run through every multiplication algorithm on small sizes too
+  struct thresholds {
+    size_t karatsuba, toom3, ntt;
+  };
+  using big_int_util::mul_thresholds;
+  thresholds const defaults = {mul_thresholds::karatsuba, mul_thresholds::toom3, mul_thresholds::ntt};
+  size_t const never = std::numeric_limits<size_t>::max();
+  thresholds const tested[] = {{2, 3, never}, {5, 11, never}, {2, 3, 1}, defaults};
+  std::default_random_engine rng(42);
+  for (auto const& t : tested) {
+    mul_thresholds::karatsuba = t.karatsuba;
+    mul_thresholds::toom3 = t.toom3;
+    mul_thresholds::ntt = t.ntt;
+    for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+      big_integer_gmp a, b;
+      a.random(rng() % (10 * max_size) + 1, rng);
+      b.random(rng() % (10 * max_size) + 1, rng);
+      big_integer A = big_integer(to_string(a));
+      big_integer B = big_integer(to_string(b));
+      EXPECT_EQ(to_string(a * b), to_string(A * B));
+      EXPECT_EQ(to_string(a * a), to_string(A *= A));
+      // copies share places, so they are squared as well
+      EXPECT_EQ(to_string(b * b), to_string(B * B));
+    }
+  }
+  mul_thresholds::karatsuba = defaults.karatsuba;
+  mul_thresholds::toom3 = defaults.toom3;
+  mul_thresholds::ntt = defaults.ntt;
+}
+
 TEST(correctness_random, div) {
   std::default_random_engine rng(322);
   for (size_t itn = 0; itn != number_of_iterations; ++itn) {
@@ -756,6 +1295,219 @@ TEST(correctness_random, mod) {
   }
 }
 
+TEST(correctness_random, div_algorithms) {
+  // lower threshold to run through recursive division on small sizes too
+  size_t const burnikel_ziegler = big_int_util::div_thresholds::burnikel_ziegler;
+  size_t const tested[] = {2, 7, burnikel_ziegler};
+  std::default_random_engine rng(322);
+  for (size_t t : tested) {
+    big_int_util::div_thresholds::burnikel_ziegler = t;
+    for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+      big_integer_gmp a, b;
+      size_t a_size = rng() % (10 * max_size) + 1;
+      a.random(a_size, rng);
+      b.random(rng() % a_size + 1, rng);
+      if (a == 0 || b == 0)
+        continue;
+      big_integer A = big_integer(to_string(a));
+      big_integer B = big_integer(to_string(b));
+      EXPECT_EQ(to_string(a / b), to_string(A / B));
+      EXPECT_EQ(to_string(a % b), to_string(A % B));
+      // divisor close to dividend
+      big_integer_gmp c = a - a / 7;
+      big_integer C = A - A / 7;
+      EXPECT_EQ(to_string(a / c), to_string(A / C));
+      EXPECT_EQ(to_string(a % c), to_string(A % C));
+    }
+  }
+  big_int_util::div_thresholds::burnikel_ziegler = burnikel_ziegler;
+}
+
+TEST(correctness_random, pow_mod) {
+  std::default_random_engine rng(322);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a, e, m;
+    a.random(rng() % max_size + 1, rng);
+    e.random(rng() % (max_size / 4) + 1, rng);
+    m.random(rng() % max_size + 1, rng);
+    if (e < 0)
+      e = -e;
+    // both odd (Montgomery) and even (Barrett) moduli
+    for (int parity = 0; parity != 2; ++parity, m += 1) {
+      if (m == 0)
+        continue;
+      big_integer_gmp am = m < 0 ? -m : m;
+      EXPECT_EQ(to_string(pow_mod(a, e, am)),
+                to_string(pow_mod(big_integer(to_string(a)), big_integer(to_string(e)), big_integer(to_string(m)))));
+    }
+  }
+}
+
+TEST(correctness_random, gcd) {
+  std::default_random_engine rng(322);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a, b, c;
+    a.random(rng() % max_size + 1, rng);
+    b.random(rng() % max_size + 1, rng);
+    c.random(rng() % (max_size / 4) + 1, rng);
+    for (int common = 0; common != 2; ++common, a *= c, b *= c) {
+      big_integer A = big_integer(to_string(a));
+      big_integer B = big_integer(to_string(b));
+      big_integer_gmp g = gcd(a, b);
+      EXPECT_EQ(to_string(g), to_string(gcd(A, B)));
+
+      big_integer x, y;
+      big_integer G = extended_gcd(A, B, x, y);
+      EXPECT_EQ(to_string(g), to_string(G));
+      EXPECT_EQ(G, A * x + B * y);
+      if (G != 0) {
+        EXPECT_TRUE((x < 0 ? -x : x) <= std::max(B < 0 ? -B : B, G));
+      }
+
+      if (b != 0 && g == 1) {
+        EXPECT_EQ(to_string(mod_inverse(a, b)), to_string(mod_inverse(A, B)));
+      }
+    }
+  }
+}
+
+TEST(correctness_random, roots) {
+  std::default_random_engine rng(322);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a;
+    a.random(rng() % (10 * max_size) + 1, rng);
+    if (a < 0)
+      a = -a;
+    big_integer A = big_integer(to_string(a));
+    EXPECT_EQ(to_string(isqrt(a)), to_string(isqrt(A)));
+    int k = static_cast<int>(rng() % 20 + 2);
+    EXPECT_EQ(to_string(iroot(a, k)), to_string(iroot(A, k)));
+    EXPECT_EQ(to_string(iroot(-a, 2 * k + 1)), to_string(iroot(-A, 2 * k + 1)));
+
+    // powers, their neighbours and 2^t multiples
+    big_integer_gmp r;
+    r.random(rng() % (max_size / 4) + 2, rng);
+    big_integer_gmp p = r * r * r;
+    if (rng() % 2 == 0)
+      p *= r * r;
+    int t = static_cast<int>(rng() % 3) * 3;
+    for (big_integer_gmp const& x : {p, p + 1, p - 1, p << t, -p}) {
+      big_integer X = big_integer(to_string(x));
+      EXPECT_EQ(is_perfect_power(x), is_perfect_power(X)) << to_string(x);
+      if (x >= 0) {
+        EXPECT_EQ(to_string(isqrt(x)), to_string(isqrt(X)));
+      }
+    }
+  }
+}
+
+TEST(correctness_random, export_import_bytes) {
+  std::default_random_engine rng(1223);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a;
+    a.random(rng() % (10 * max_size) + 1, rng);
+    big_integer A = big_integer(to_string(a));
+    for (byte_order order : {byte_order::little_endian, byte_order::big_endian})
+      for (sign_encoding encoding : {sign_encoding::twos_complement, sign_encoding::sign_magnitude}) {
+        std::vector<unsigned char> bytes = export_bytes(A, order, encoding);
+        EXPECT_EQ(export_bytes_length(A, encoding), bytes.size());
+        EXPECT_EQ(to_string(a), to_string(import_bytes(bytes.data(), bytes.size(), order, encoding)));
+        // sign extension (or zero bytes above the sign bit) does not change the number
+        if (order == byte_order::little_endian && encoding == sign_encoding::twos_complement) {
+          bytes.push_back(A < 0 ? 0xff : 0x00);
+          EXPECT_EQ(to_string(a), to_string(import_bytes(bytes.data(), bytes.size(), order, encoding)));
+        }
+      }
+    big_integer B(A.places());
+    EXPECT_EQ(A, B);
+    EXPECT_EQ(to_string(a * 3), to_string(B * 3));
+  }
+}
+
+TEST(correctness_random, string_conv_algorithms) {
+  // lower threshold to run through divide-and-conquer conversions on small sizes too
+  size_t const divide_and_conquer = big_int_util::conversion_thresholds::divide_and_conquer;
+  size_t const tested[] = {1, 3, divide_and_conquer};
+  std::default_random_engine rng(42);
+  for (size_t t : tested) {
+    big_int_util::conversion_thresholds::divide_and_conquer = t;
+    for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+      big_integer_gmp a;
+      a.random(rng() % (20 * max_size) + 1, rng);
+      std::string str = to_string(a);
+      EXPECT_EQ(str, to_string(big_integer(str)));
+      // chunk-sized runs of zeros in the middle
+      big_integer_gmp b = a * big_integer_gmp("1000000000000000000000000000000000000") + 7;
+      str = to_string(b);
+      EXPECT_EQ(str, to_string(big_integer(str)));
+    }
+  }
+  big_int_util::conversion_thresholds::divide_and_conquer = divide_and_conquer;
+}
+
+TEST(correctness_random, string_conv_bases) {
+  size_t const divide_and_conquer = big_int_util::conversion_thresholds::divide_and_conquer;
+  size_t const tested[] = {1, divide_and_conquer};
+  std::default_random_engine rng(43);
+  for (size_t t : tested) {
+    big_int_util::conversion_thresholds::divide_and_conquer = t;
+    for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+      big_integer_gmp a;
+      a.random(rng() % (20 * max_size) + 1, rng);
+      big_integer A = big_integer(to_string(a));
+      for (int base : {2, 3, 7, 8, 16, 32, 36}) {
+        std::string str = to_string(a, base);
+        EXPECT_EQ(str, to_string(A, base));
+        EXPECT_EQ(A, big_integer(str, base));
+      }
+    }
+  }
+  big_int_util::conversion_thresholds::divide_and_conquer = divide_and_conquer;
+}
+
+TEST(correctness_random, parallel_mul_and_conv) {
+  // tiny grain sizes, so that small operations are split between threads too
+  using big_int_util::parallel_thresholds;
+  using big_int_util::mul_thresholds;
+  struct grains {
+    size_t mul, ntt, conversion;
+  };
+  grains const defaults = {parallel_thresholds::mul, parallel_thresholds::ntt, parallel_thresholds::conversion};
+  size_t const ntt = mul_thresholds::ntt, divide_and_conquer = big_int_util::conversion_thresholds::divide_and_conquer;
+  big_int_util::set_parallel_threads(4);
+  parallel_thresholds::mul = 8;
+  parallel_thresholds::ntt = 64;
+  parallel_thresholds::conversion = 4;
+  big_int_util::conversion_thresholds::divide_and_conquer = 3;
+  std::default_random_engine rng(42);
+  for (size_t t : {ntt, size_t{1}}) {
+    mul_thresholds::ntt = t;
+    for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+      big_integer_gmp a, b;
+      a.random(rng() % (10 * max_size) + 1, rng);
+      b.random(rng() % (10 * max_size) + 1, rng);
+      big_integer A = big_integer(to_string(a));
+      big_integer B = big_integer(to_string(b));
+      EXPECT_EQ(to_string(a * b), to_string(A * B));
+      EXPECT_EQ(to_string(a * a), to_string(A * A));
+      EXPECT_EQ(to_string(a / b), to_string(A / B));
+      EXPECT_EQ(to_string(a, 7), to_string(A, 7));
+    }
+  }
+
+  // exceptions of tasks are passed to the waiting thread
+  big_int_util::task_group group;
+  group.run([] { throw std::runtime_error("task"); });
+  EXPECT_THROW(group.wait(), std::runtime_error);
+
+  big_int_util::set_parallel_threads(1);
+  parallel_thresholds::mul = defaults.mul;
+  parallel_thresholds::ntt = defaults.ntt;
+  parallel_thresholds::conversion = defaults.conversion;
+  mul_thresholds::ntt = ntt;
+  big_int_util::conversion_thresholds::divide_and_conquer = divide_and_conquer;
+}
+
 TEST(correctness_random, bitwise) {
   std::default_random_engine rng(42);
   for (size_t itn = 0; itn != number_of_iterations; ++itn) {
@@ -789,7 +1541,126 @@ TEST(correctness_random, bit_shifts) {
   }
 }
 
+TEST(correctness_random, fused_operations) {
+  using namespace big_int_util::expr;
+  std::default_random_engine rng(42);
+  std::uniform_int_distribution<int> length(1, 1000), small(-100000, 100000);
+  for (size_t itn = 0; itn != 10 * number_of_iterations; ++itn) {
+    big_integer_gmp ga, gb, gc, gm;
+    ga.random(length(rng), rng);
+    gb.random(length(rng), rng);
+    gc.random(length(rng), rng);
+    gm.random(length(rng), rng);
+    int s = small(rng), bits = length(rng);
+    big_integer a(to_string(ga)), b(to_string(gb)), c(to_string(gc)), m(to_string(gm)), r = c;
+
+    addmul(r, a, b);
+    EXPECT_EQ(to_string(gc + ga * gb), to_string(r));
+    submul(r, a, s);
+    EXPECT_EQ(to_string(gc + ga * gb - ga * s), to_string(r));
+    mul(r, a, s);
+    EXPECT_EQ(to_string(ga * s), to_string(r));
+    mul_2exp(r, a, bits);
+    EXPECT_EQ(to_string(ga << bits), to_string(r));
+    if (gm != 0) {
+      big_integer q;
+      divmod(q, r, a, m);
+      EXPECT_EQ(to_string(ga / gm), to_string(q));
+      EXPECT_EQ(to_string(ga % gm), to_string(r));
+      EXPECT_EQ(to_string((ga * gb + gc) % gm), to_string(big_integer((lazy(a) * b + c) % m)));
+    }
+    assign(r, lazy(a) * s + lazy(b) * c - (lazy(c) << bits) + s);
+    EXPECT_EQ(to_string(ga * s + gb * gc - (gc << bits) + s), to_string(r));
+  }
+}
+
+namespace {
+// a modulo 2^Bits in the range of fixed_integer<Bits, Signed>
+big_integer_gmp wrap(big_integer_gmp const& a, size_t bits, bool is_signed) {
+  big_integer_gmp m = big_integer_gmp(1) << static_cast<int>(bits);
+  big_integer_gmp r = a & (m - 1);
+  if (is_signed && r >= (m >> 1))
+    r -= m;
+  return r;
+}
+
+template<size_t Bits, bool Signed>
+void check_fixed_integer_random() {
+  using fixed = fixed_integer<Bits, Signed>;
+  std::default_random_engine rng(42);
+  std::uniform_int_distribution<int> length(1, Bits + 10);
+  for (size_t itn = 0; itn != 30 * number_of_iterations; ++itn) {
+    big_integer_gmp a, b;
+    a.random(length(rng), rng);
+    b.random(length(rng), rng);
+    // conversion from big_integer wraps
+    fixed A(big_integer(to_string(a))), B(big_integer(to_string(b)));
+    a = wrap(a, Bits, Signed);
+    b = wrap(b, Bits, Signed);
+    ASSERT_EQ(to_string(a), to_string(A));
+    ASSERT_EQ(to_string(b), to_string(B));
+
+    EXPECT_EQ(to_string(wrap(a + b, Bits, Signed)), to_string(A + B));
+    EXPECT_EQ(to_string(wrap(a - b, Bits, Signed)), to_string(A - B));
+    EXPECT_EQ(to_string(wrap(a * b, Bits, Signed)), to_string(A * B));
+    EXPECT_EQ(to_string(wrap(-a, Bits, Signed)), to_string(-A));
+    EXPECT_EQ(to_string(wrap(~a, Bits, Signed)), to_string(~A));
+    if (b != 0) {
+      EXPECT_EQ(to_string(wrap(a / b, Bits, Signed)), to_string(A / B));
+      EXPECT_EQ(to_string(a % b), to_string(A % B));
+    }
+    EXPECT_EQ(to_string(a & b), to_string(A & B));
+    EXPECT_EQ(to_string(a | b), to_string(A | B));
+    EXPECT_EQ(to_string(a ^ b), to_string(A ^ B));
+
+    int shift = length(rng) - 1;
+    EXPECT_EQ(to_string(wrap(a << shift, Bits, Signed)), to_string(A << shift));
+    EXPECT_EQ(to_string(a >> shift), to_string(A >> shift));
+
+    EXPECT_EQ(a < b, A < B);
+    EXPECT_EQ(a > b, A > B);
+    EXPECT_EQ(a <= b, A <= B);
+    EXPECT_EQ(a >= b, A >= B);
+    EXPECT_EQ(a == b, A == B);
+  }
+}
+}
+
+TEST(correctness_random, fixed_integer) {
+  check_fixed_integer_random<256, true>();
+  check_fixed_integer_random<256, false>();
+  check_fixed_integer_random<512, true>();
+  check_fixed_integer_random<512, false>();
+  check_fixed_integer_random<100, true>();
+  check_fixed_integer_random<31, false>();
+}
+
 // TODO: extend due to idea
+#ifdef BIGINT_ATOMIC_REFCOUNT
+TEST(correctness_threads, shared_copies) {
+  const big_integer m = (big_integer(1) << 1000) - 1;
+  std::vector<std::thread> workers;
+  std::vector<int> failures(4, 0);
+  for (int t = 0; t < 4; t++)
+    workers.emplace_back([&m, &failures, t] {
+      for (int i = 0; i < 2000; i++)
+      {
+        // copies share places of m, mutation of a copy unshares it
+        big_integer a = m, b = a;
+        a += t;
+        b *= 2;
+        if (a - t != m || b != m + m || (b - a) / m != (t == 0))
+          failures[t]++;
+      }
+    });
+  for (std::thread &worker : workers)
+    worker.join();
+  for (int t = 0; t < 4; t++)
+    EXPECT_EQ(0, failures[t]);
+  EXPECT_EQ((big_integer(1) << 1000) - 1, m);
+}
+#endif
+
 TEST(correctness_twos_complement, simple) {
   std::string a = "-36893488147419103232"; // -(1 << 65)
   std::string b = "147573952589676412928"; //  (1 << 67)
@@ -0,0 +1,304 @@
+/* Nikolai Kholiavin, M3138 */
+
+#include <vector>
+#include <limits>
+#include <cmath>
+
+#include "conversion.h"
+#include "division.h"
+#include "multiplication.h"
+#include "parallel.h"
+
+namespace big_int_util
+{
+  size_t conversion_thresholds::divide_and_conquer = 40;
+
+  namespace
+  {
+    constexpr char DIGITS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+    // log2(base) for power-of-two bases, 0 for others
+    int base_bits(int base)
+    {
+      int bits = 0;
+      while ((1 << bits) < base)
+        bits++;
+      return (1 << bits) == base ? bits : 0;
+    }
+
+    // base and the largest power of it fitting into a single place (10^9 or 10^19 for decimal)
+    struct radix
+    {
+      place_t base, chunk;
+      size_t chunk_digits;
+
+      explicit radix(int base) : base(static_cast<place_t>(base)), chunk(this->base), chunk_digits(1)
+      {
+        while (chunk <= std::numeric_limits<place_t>::max() / this->base)
+        {
+          chunk *= this->base;
+          chunk_digits++;
+        }
+      }
+    };
+
+    // powers[k] = chunk^(2^k) without leading zero places, computed once per conversion
+    using power_table = std::vector<std::vector<place_t>>;
+
+    void push_square(power_table &powers)
+    {
+      const std::vector<place_t> &last = powers.back();
+      std::vector<place_t> square(2 * last.size());
+      mul(square.data(), last.data(), last.size(), last.data(), last.size());
+      square.resize(normalized_size(square.data(), square.size()));
+      powers.push_back(std::move(square));
+    }
+
+    bool less(const place_t *a, size_t n, const std::vector<place_t> &b)
+    {
+      return n != b.size() ? n < b.size() : cmp_n(a, b.data(), n) < 0;
+    }
+
+    // writes exactly 'width' digits of v < base^width
+    void write_chunk(char *out, place_t v, size_t width, place_t base)
+    {
+      // constant divisor is a multiplication
+      if (base == 10)
+        for (size_t i = width; i > 0; i--, v /= 10)
+          out[i - 1] = static_cast<char>('0' + v % 10);
+      else
+        for (size_t i = width; i > 0; i--, v /= base)
+          out[i - 1] = DIGITS[v % base];
+    }
+
+    size_t chunk_width(place_t v, place_t base)
+    {
+      size_t width = 1;
+      for (; v >= base; v /= base)
+        width++;
+      return width;
+    }
+
+    // writes a[0..n) padded with zeros to 'pad' digits (no leading zeros and nothing for zero if pad is 0)
+    void to_digits_chunked(char *&out, const place_t *a, size_t n, size_t pad, const radix &r)
+    {
+      std::vector<place_t> rest(a, a + n), chunks;
+      // a chunk holds more than half of a place
+      chunks.reserve(2 * n + 1);
+      while (n > 0)
+      {
+        chunks.push_back(div_1(rest.data(), rest.data(), n, r.chunk));
+        n = normalized_size(rest.data(), n);
+      }
+
+      size_t digits = chunks.empty() ? 0 : chunk_width(chunks.back(), r.base) + (chunks.size() - 1) * r.chunk_digits;
+      for (; pad > digits; pad--)
+        *out++ = '0';
+      if (chunks.empty())
+        return;
+      size_t width = chunk_width(chunks.back(), r.base);
+      for (size_t i = chunks.size(); i > 0; i--)
+      {
+        write_chunk(out, chunks[i - 1], width, r.base);
+        out += width;
+        width = r.chunk_digits;
+      }
+    }
+
+    // divide-and-conquer: a = q * chunk^(2^k) + r, conversion of q and r (padded) is recursive
+    void to_digits_rec(char *&out, const place_t *a, size_t n, size_t pad, const radix &r,
+                       const power_table &powers, int level)
+    {
+      n = normalized_size(a, n);
+      while (level >= 0 && (2 * powers[level].size() > n + 1 || less(a, n, powers[level])))
+        level--;
+      if (level < 0 || n < conversion_thresholds::divide_and_conquer)
+      {
+        to_digits_chunked(out, a, n, pad, r);
+        return;
+      }
+
+      const std::vector<place_t> &p = powers[level];
+      size_t low_digits = r.chunk_digits << level;
+      std::vector<place_t> q(n - p.size() + 1), rem(p.size());
+      div_qr(q.data(), rem.data(), a, n, p.data(), p.size());
+      size_t high_pad = pad > low_digits ? pad - low_digits : 0;
+      if (parallel_worth(n, parallel_thresholds::conversion))
+      {
+        // the remainder takes exactly low_digits digits, so it is written to a buffer of its own meanwhile
+        std::vector<char> low(low_digits);
+        task_group group;
+        group.run([&]
+          {
+            char *low_out = low.data();
+            to_digits_rec(low_out, rem.data(), rem.size(), low_digits, r, powers, level - 1);
+          });
+        to_digits_rec(out, q.data(), q.size(), high_pad, r, powers, level);
+        group.wait();
+        out = std::copy(low.begin(), low.end(), out);
+        return;
+      }
+      to_digits_rec(out, q.data(), q.size(), high_pad, r, powers, level);
+      to_digits_rec(out, rem.data(), rem.size(), low_digits, r, powers, level - 1);
+    }
+
+    // res[0..size) = value of s[0..len) by chunk_digits digits
+    void from_digits_chunked(place_t *res, size_t size, const char *s, size_t len, const radix &r)
+    {
+      std::fill_n(res, size, 0);
+      size_t used = 0;
+      for (size_t i = 0, width = (len - 1) % r.chunk_digits + 1; i < len; i += width, width = r.chunk_digits)
+      {
+        place_t chunk = 0, scale = 1;
+        for (size_t j = i; j < i + width; j++)
+        {
+          chunk = chunk * r.base + static_cast<place_t>(digit_value(s[j], static_cast<int>(r.base)));
+          scale *= r.base;
+        }
+        place_t carry = mul_1(res, res, used, scale);
+        carry += add_1(res, res, used, chunk);
+        if (carry != 0)
+          res[used++] = carry;
+      }
+    }
+
+    // divide-and-conquer: value(s) = value(high digits) * chunk^(2^k) + value(low digits)
+    void from_digits_rec(place_t *res, size_t size, const char *s, size_t len, const radix &r,
+                         const power_table &powers, int level)
+    {
+      while (level >= 0 && (r.chunk_digits << level) >= len)
+        level--;
+      if (level < 0 || len < conversion_thresholds::divide_and_conquer * r.chunk_digits)
+      {
+        from_digits_chunked(res, size, s, len, r);
+        return;
+      }
+
+      int base = static_cast<int>(r.base);
+      const std::vector<place_t> &p = powers[level];
+      size_t low_digits = r.chunk_digits << level, high_len = len - low_digits;
+      size_t high_size = max_digit_places(high_len, base);
+      std::vector<place_t> high(high_size), prod(high_size + p.size());
+      from_digits_rec(high.data(), high_size, s, high_len, r, powers, level - 1);
+      mul(prod.data(), high.data(), high_size, p.data(), p.size());
+      size_t copied = std::min(size, prod.size());
+      std::copy_n(prod.data(), copied, res);
+      std::fill(res + copied, res + size, 0);
+
+      // low part is less than the power, so it fits into its size
+      std::vector<place_t> &low = high;
+      low.resize(p.size());
+      from_digits_rec(low.data(), low.size(), s + high_len, low_digits, r, powers, level - 1);
+      add(res, res, size, low.data(), low.size());
+    }
+
+    /* Power-of-two bases: every digit is 'bits' bits of the value */
+    size_t to_digits_bits(char *out, const place_t *a, size_t n, int bits)
+    {
+      size_t total = n * PLACE_BITS - leading_zeros(a[n - 1]), len = (total + bits - 1) / bits;
+      place_t mask = (place_t{1} << bits) - 1;
+      for (size_t i = 0, pos = 0; i < len; i++, pos += bits)
+      {
+        size_t w = pos / PLACE_BITS;
+        int off = static_cast<int>(pos % PLACE_BITS);
+        place_t v = a[w] >> off;
+        // the digit crosses a place boundary
+        if (off + bits > PLACE_BITS && w + 1 < n)
+          v |= a[w + 1] << (PLACE_BITS - off);
+        out[len - 1 - i] = DIGITS[v & mask];
+      }
+      return len;
+    }
+
+    void from_digits_bits(place_t *res, size_t size, const char *s, size_t len, int bits)
+    {
+      // digits are read forward (backward reading is not prefetched as well), so places are
+      // filled from the highest one, each is gathered in a register
+      size_t total = len * bits, cur = (total - 1) / PLACE_BITS;
+      std::fill(res + cur + 1, res + size, 0);
+      place_t acc = 0;
+      for (size_t i = 0, pos = total; i < len; i++)
+      {
+        place_t v = static_cast<place_t>(digit_value(s[i], 1 << bits));
+        pos -= bits;
+        size_t w = pos / PLACE_BITS;
+        int off = static_cast<int>(pos % PLACE_BITS);
+        if (w != cur)
+        {
+          // the digit may cross the boundary, its high bits belong to the current place
+          if (off + bits > PLACE_BITS)
+            acc |= v >> (PLACE_BITS - off);
+          res[cur] = acc;
+          cur = w;
+          acc = 0;
+        }
+        acc |= v << off;
+      }
+      res[cur] = acc;
+    }
+  }
+
+  bool is_valid_base(int base)
+  {
+    return base >= 2 && base <= 36;
+  }
+
+  size_t max_digits(size_t n, int base)
+  {
+    size_t bits = n * PLACE_BITS;
+    if (base == 10)
+      // log10(2) < 0.30103
+      return bits / 100000 * 30103 + (bits % 100000) * 30103 / 100000 + 2;
+    if (int b = base_bits(base))
+      return bits / b + 1;
+    // relative error of the double estimate is far below the margin
+    return static_cast<size_t>(static_cast<double>(bits) / std::log2(base) * (1 + 1e-9)) + 2;
+  }
+
+  size_t to_digits(char *out, const place_t *a, size_t n, int base)
+  {
+    n = normalized_size(a, n);
+    if (n == 0)
+    {
+      *out = '0';
+      return 1;
+    }
+    if (int bits = base_bits(base))
+      return to_digits_bits(out, a, n, bits);
+
+    radix r(base);
+    power_table powers(1, std::vector<place_t>(1, r.chunk));
+    if (n >= conversion_thresholds::divide_and_conquer)
+      while (4 * powers.back().size() <= n + 3)
+        push_square(powers);
+
+    char *begin = out;
+    to_digits_rec(out, a, n, 0, r, powers, static_cast<int>(powers.size()) - 1);
+    return static_cast<size_t>(out - begin);
+  }
+
+  size_t max_digit_places(size_t len, int base)
+  {
+    if (int bits = base_bits(base))
+      return len * bits / PLACE_BITS + 1;
+    // a chunk fits into a single place
+    return len / radix(base).chunk_digits + 1;
+  }
+
+  void from_digits(place_t *res, const char *s, size_t len, int base)
+  {
+    size_t size = max_digit_places(len, base);
+    if (int bits = base_bits(base))
+    {
+      from_digits_bits(res, size, s, len, bits);
+      return;
+    }
+
+    radix r(base);
+    power_table powers(1, std::vector<place_t>(1, r.chunk));
+    if (len >= conversion_thresholds::divide_and_conquer * r.chunk_digits)
+      while ((r.chunk_digits << powers.size()) < len)
+        push_square(powers);
+    from_digits_rec(res, size, s, len, r, powers, static_cast<int>(powers.size()) - 1);
+  }
+} // end of 'big_int_util' namespace
@@ -0,0 +1,49 @@
+/* Nikolai Kholiavin, M3138 */
+
+#ifndef CONVERSION_H
+#define CONVERSION_H
+
+#include "limb_arithmetic.h"
+
+namespace big_int_util
+{
+  /***
+   * Conversion to and from digits in base 2..36 (digits are '0'..'9', letters for the rest).
+   * Power-of-two bases are a re-encoding of bits (linear time), others go by chunks, the largest
+   * power of the base fitting into a single place, and by their powers for long numbers.
+   ***/
+
+  /* Conversion threshold (in places), tunable */
+  struct conversion_thresholds
+  {
+    // conversion by single-place chunks (10^9 or 10^19 for decimal) below, divide-and-conquer by their powers from this size on
+    static size_t divide_and_conquer;
+  };
+
+  // true if base is supported
+  bool is_valid_base(int base);
+  // value of digit c in base, -1 if it is not a digit (letters of either case are accepted),
+  // selects instead of branches, as digits and letters are mixed unpredictably
+  inline int digit_value(char c, int base)
+  {
+    unsigned u = static_cast<unsigned char>(c);
+    unsigned digit = u - unsigned{'0'}, letter = (u | 0x20u) - unsigned{'a'}, v = 36;
+    v = letter < 26 ? letter + 10 : v;
+    v = digit < 10 ? digit : v;
+    return v < static_cast<unsigned>(base) ? static_cast<int>(v) : -1;
+  }
+
+  // upper bound of number of digits of an n-place value
+  size_t max_digits(size_t n, int base);
+  // writes digits of a[0..n) to out (lowercase, no leading zeros, "0" for zero),
+  // out must have max_digits(n, base) chars, returns number of digits written
+  size_t to_digits(char *out, const place_t *a, size_t n, int base);
+
+  // upper bound of number of places of a len-digit value
+  size_t max_digit_places(size_t len, int base);
+  // res[0..max_digit_places(len, base)) = value of digits s[0..len), len > 0,
+  // all chars must be digits of the base
+  void from_digits(place_t *res, const char *s, size_t len, int base);
+} // end of 'big_int_util' namespace
+
+#endif // CONVERSION_H
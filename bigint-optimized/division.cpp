@@ -0,0 +1,122 @@
+/* Nikolai Kholiavin, M3138 */
+
+#include <vector>
+
+#include "division.h"
+#include "multiplication.h"
+
+namespace big_int_util
+{
+  size_t div_thresholds::burnikel_ziegler = 40;
+
+  namespace
+  {
+    /* All functions below require normalized divisor (highest bit of d[dn - 1] is set) */
+
+    // Knuth's algorithm D: q[0..an - dn) and returned high quotient place (0 or 1)
+    // are a[0..an) / d[0..dn), remainder is left in a[0..dn), an >= dn
+    place_t schoolbook_div(place_t *q, place_t *a, size_t an, const place_t *d, size_t dn)
+    {
+      place_t qh = cmp_n(a + an - dn, d, dn) >= 0;
+      if (qh)
+        sub_n(a + an - dn, a + an - dn, d, dn);
+
+      // 2 leading places of divisor for quotient digits estimate
+      place_t d1 = d[dn - 1], d0 = dn >= 2 ? d[dn - 2] : 0, v = reciprocal(d1);
+      for (size_t j = an - dn; j-- > 0;)
+      {
+        // remainder prefix a[j..j + dn] is less than d * base, so n2 <= d1
+        place_t n2 = a[j + dn];
+        place_t qt = div_3_2_estimate(n2, a[j + dn - 1], dn >= 2 ? a[j + dn - 2] : 0, d1, d0, v);
+
+        place_t borrow = submul_1(a + j, d, dn, qt);
+        if (n2 < borrow)
+        {
+          // wrong, correct estimate
+          qt--;
+          add_n(a + j, a + j, d, dn);
+        }
+        a[j + dn] = 0;
+        q[j] = qt;
+      }
+      return qh;
+    }
+
+    place_t divide_2n_n(place_t *q, place_t *a, const place_t *d, size_t n);
+
+    // a[0..dn + k) / d[0..dn), k <= dn: q[0..k) and returned high quotient place, remainder in a[0..dn);
+    // quotient is estimated by division of 2k leading places by k leading places of divisor
+    place_t divide_block(place_t *q, place_t *a, size_t k, const place_t *d, size_t dn)
+    {
+      place_t qh = divide_2n_n(q, a + dn - k, d + dn - k, k);
+      if (k == dn)
+        return qh;
+
+      // subtract quotient by lower divisor places product
+      std::vector<place_t> prod(dn);
+      mul(prod.data(), q, k, d, dn - k);
+      place_t borrow = sub_n(a, a, prod.data(), dn);
+      if (qh)
+        borrow += sub_n(a + k, a + k, d, dn - k);
+      while (borrow != 0)
+      {
+        qh -= sub_1(q, q, k, 1);
+        borrow -= add_n(a, a, d, dn);
+      }
+      return qh;
+    }
+
+    // Burnikel-Ziegler recursive division of a[0..2n) by d[0..n):
+    // q[0..n) and returned high quotient place, remainder in a[0..n)
+    place_t divide_2n_n(place_t *q, place_t *a, const place_t *d, size_t n)
+    {
+      if (n < std::max(div_thresholds::burnikel_ziegler, size_t{2}))
+        return schoolbook_div(q, a, 2 * n, d, n);
+      size_t lo = n / 2, hi = n - lo;
+      place_t qh = divide_block(q + lo, a + lo, hi, d, n);
+      divide_block(q, a, lo, d, n);
+      return qh;
+    }
+
+    // a[0..an) / d[0..dn): q[0..an - dn) and returned high quotient place, remainder in a[0..dn)
+    place_t divide(place_t *q, place_t *a, size_t an, const place_t *d, size_t dn)
+    {
+      if (dn < div_thresholds::burnikel_ziegler || an == dn)
+        return schoolbook_div(q, a, an, d, dn);
+      // split quotient into dn-sized blocks, the highest one is the smallest
+      size_t qn = an - dn, off = qn - ((qn - 1) % dn + 1);
+      place_t qh = divide_block(q + off, a + off, qn - off, d, dn);
+      while (off > 0)
+      {
+        off -= dn;
+        divide_block(q + off, a + off, dn, d, dn);
+      }
+      return qh;
+    }
+  }
+
+  void div_qr(place_t *q, place_t *r, const place_t *a, size_t an, const place_t *d, size_t dn)
+  {
+    if (dn == 1)
+    {
+      r[0] = div_1(q, a, an, d[0]);
+      return;
+    }
+
+    // normalize divisor (highest bit is set), extra place for dividend makes high quotient place 0
+    int shift = leading_zeros(d[dn - 1]);
+    std::vector<place_t> nd(d, d + dn), na(an + 1);
+    std::copy_n(a, an, na.data());
+    if (shift != 0)
+    {
+      lshift(nd.data(), nd.data(), dn, shift);
+      na[an] = lshift(na.data(), na.data(), an, shift);
+    }
+
+    divide(q, na.data(), an + 1, nd.data(), dn);
+    if (shift != 0)
+      rshift(r, na.data(), dn, shift);
+    else
+      std::copy_n(na.data(), dn, r);
+  }
+} // end of 'big_int_util' namespace
@@ -0,0 +1,22 @@
+/* Nikolai Kholiavin, M3138 */
+
+#ifndef DIVISION_H
+#define DIVISION_H
+
+#include "limb_arithmetic.h"
+
+namespace big_int_util
+{
+  /* Division algorithm thresholds (in places of the divisor), tunable */
+  struct div_thresholds
+  {
+    // schoolbook (Knuth's algorithm D) below, Burnikel-Ziegler recursive division from this size on
+    static size_t burnikel_ziegler;
+  };
+
+  // q[0..an - dn + 1) = a[0..an) / d[0..dn), r[0..dn) = a[0..an) % d[0..dn),
+  // an >= dn > 0, d[dn - 1] != 0, results must not overlap with operands
+  void div_qr(place_t *q, place_t *r, const place_t *a, size_t an, const place_t *d, size_t dn);
+} // end of 'big_int_util' namespace
+
+#endif // DIVISION_H
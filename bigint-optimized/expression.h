@@ -0,0 +1,393 @@
+/* Nikolai Kholiavin, M3138 */
+
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include <type_traits>
+#include <utility>
+
+#include "big_integer.h"
+
+namespace big_int_util
+{
+  namespace expr
+  {
+    /***
+     * Optional expression templates: lazy(a) starts an expression of +, -, *, % and << over
+     * numbers and ints, which is evaluated into a single destination by assign, add_assign and
+     * sub_assign (or converted to big_integer). Sums of products are accumulated by addmul and
+     * submul, the rest of operations are done in place of the destination; operands which are
+     * not numbers themselves (e.g. the right side of a * (b + c)) are evaluated into temporaries.
+     * Expressions keep references to their operands, so they are evaluated in the full
+     * expression where they are built.
+     ***/
+
+    struct node_tag
+    {};
+
+    template<typename T>
+    struct is_node : std::is_base_of<node_tag, T>
+    {};
+
+    // common part of expression nodes (Derived has assign_to and refers_to)
+    template<typename Derived>
+    struct node : node_tag
+    {
+      // dest +=/-= value of the node, evaluated into a temporary unless the node has a fused way
+      void add_to(big_integer &dest, bool subtract) const
+      {
+        big_integer value;
+        derived().assign_to(value);
+        if (subtract)
+          dest -= value;
+        else
+          dest += value;
+      }
+
+      operator big_integer() const
+      {
+        big_integer res;
+        derived().assign_to(res);
+        return res;
+      }
+
+    private:
+      const Derived & derived() const
+      {
+        return static_cast<const Derived &>(*this);
+      }
+    };
+
+    /* Leaves */
+    struct number_node : node<number_node>
+    {
+      const big_integer &value;
+
+      explicit number_node(const big_integer &value) : value(value)
+      {}
+
+      bool refers_to(const big_integer &x) const
+      {
+        return &value == &x;
+      }
+
+      void assign_to(big_integer &dest) const
+      {
+        dest = value;
+      }
+
+      void add_to(big_integer &dest, bool subtract) const
+      {
+        if (subtract)
+          dest -= value;
+        else
+          dest += value;
+      }
+    };
+
+    struct constant_node : node<constant_node>
+    {
+      big_integer value;
+
+      explicit constant_node(int value) : value(value)
+      {}
+
+      bool refers_to(const big_integer &) const
+      {
+        return false;
+      }
+
+      void assign_to(big_integer &dest) const
+      {
+        dest = value;
+      }
+
+      void add_to(big_integer &dest, bool subtract) const
+      {
+        if (subtract)
+          dest -= value;
+        else
+          dest += value;
+      }
+    };
+
+    // value of an operand: leaves are referenced, other nodes are evaluated into a temporary
+    template<typename E>
+    struct evaluated
+    {
+      big_integer value;
+
+      explicit evaluated(const E &e)
+      {
+        e.assign_to(value);
+      }
+
+      const big_integer & get() const
+      {
+        return value;
+      }
+    };
+
+    template<>
+    struct evaluated<number_node>
+    {
+      const big_integer &value;
+
+      explicit evaluated(const number_node &e) : value(e.value)
+      {}
+
+      const big_integer & get() const
+      {
+        return value;
+      }
+    };
+
+    template<>
+    struct evaluated<constant_node>
+    {
+      const big_integer &value;
+
+      explicit evaluated(const constant_node &e) : value(e.value)
+      {}
+
+      const big_integer & get() const
+      {
+        return value;
+      }
+    };
+
+    /* Operations */
+    template<typename L, typename R>
+    struct sum_node : node<sum_node<L, R>>
+    {
+      L left;
+      R right;
+      bool subtract;
+
+      sum_node(L left, R right, bool subtract) : left(std::move(left)), right(std::move(right)), subtract(subtract)
+      {}
+
+      bool refers_to(const big_integer &x) const
+      {
+        return left.refers_to(x) || right.refers_to(x);
+      }
+
+      void assign_to(big_integer &dest) const
+      {
+        left.assign_to(dest);
+        right.add_to(dest, subtract);
+      }
+
+      void add_to(big_integer &dest, bool negative) const
+      {
+        left.add_to(dest, negative);
+        right.add_to(dest, negative != subtract);
+      }
+    };
+
+    template<typename L, typename R>
+    struct product_node : node<product_node<L, R>>
+    {
+      L left;
+      R right;
+
+      product_node(L left, R right) : left(std::move(left)), right(std::move(right))
+      {}
+
+      bool refers_to(const big_integer &x) const
+      {
+        return left.refers_to(x) || right.refers_to(x);
+      }
+
+      void assign_to(big_integer &dest) const
+      {
+        evaluated<R> r(right);
+        assign_product(dest, left, r.get());
+      }
+
+      void add_to(big_integer &dest, bool subtract) const
+      {
+        evaluated<L> l(left);
+        evaluated<R> r(right);
+        if (subtract)
+          submul(dest, l.get(), r.get());
+        else
+          addmul(dest, l.get(), r.get());
+      }
+
+    private:
+      // a product of leaves is written to dest, other left operands are evaluated in it
+      static void assign_product(big_integer &dest, const number_node &l, const big_integer &r)
+      {
+        mul(dest, l.value, r);
+      }
+
+      static void assign_product(big_integer &dest, const constant_node &l, const big_integer &r)
+      {
+        mul(dest, l.value, r);
+      }
+
+      template<typename E>
+      static void assign_product(big_integer &dest, const E &l, const big_integer &r)
+      {
+        l.assign_to(dest);
+        dest *= r;
+      }
+    };
+
+    template<typename L, typename R>
+    struct residue_node : node<residue_node<L, R>>
+    {
+      L left;
+      R right;
+
+      residue_node(L left, R right) : left(std::move(left)), right(std::move(right))
+      {}
+
+      bool refers_to(const big_integer &x) const
+      {
+        return left.refers_to(x) || right.refers_to(x);
+      }
+
+      void assign_to(big_integer &dest) const
+      {
+        evaluated<R> r(right);
+        left.assign_to(dest);
+        dest %= r.get();
+      }
+    };
+
+    template<typename E>
+    struct shift_node : node<shift_node<E>>
+    {
+      E left;
+      int bits;
+
+      shift_node(E left, int bits) : left(std::move(left)), bits(bits)
+      {}
+
+      bool refers_to(const big_integer &x) const
+      {
+        return left.refers_to(x);
+      }
+
+      void assign_to(big_integer &dest) const
+      {
+        shift(dest, left, bits);
+      }
+
+    private:
+      static void shift(big_integer &dest, const number_node &l, int bits)
+      {
+        mul_2exp(dest, l.value, bits);
+      }
+
+      template<typename T>
+      static void shift(big_integer &dest, const T &l, int bits)
+      {
+        l.assign_to(dest);
+        dest <<= bits;
+      }
+    };
+
+    /* Building of expressions */
+    inline number_node lazy(const big_integer &a)
+    {
+      return number_node(a);
+    }
+
+    inline number_node as_node(const big_integer &a)
+    {
+      return number_node(a);
+    }
+
+    inline constant_node as_node(int a)
+    {
+      return constant_node(a);
+    }
+
+    template<typename E, typename = typename std::enable_if<is_node<E>::value>::type>
+    E as_node(const E &e)
+    {
+      return e;
+    }
+
+    template<typename T>
+    struct node_of
+    {
+      using type = decltype(as_node(std::declval<const T &>()));
+    };
+
+    // at least one operand is a node, the other one is a node, a number or an int
+    template<typename L, typename R>
+    struct enable_operands
+      : std::enable_if<(is_node<L>::value || is_node<R>::value) &&
+                       (is_node<L>::value || std::is_same<L, big_integer>::value || std::is_same<L, int>::value) &&
+                       (is_node<R>::value || std::is_same<R, big_integer>::value || std::is_same<R, int>::value)>
+    {};
+
+    template<typename L, typename R, typename = typename enable_operands<L, R>::type>
+    sum_node<typename node_of<L>::type, typename node_of<R>::type> operator+(const L &l, const R &r)
+    {
+      return {as_node(l), as_node(r), false};
+    }
+
+    template<typename L, typename R, typename = typename enable_operands<L, R>::type>
+    sum_node<typename node_of<L>::type, typename node_of<R>::type> operator-(const L &l, const R &r)
+    {
+      return {as_node(l), as_node(r), true};
+    }
+
+    template<typename L, typename R, typename = typename enable_operands<L, R>::type>
+    product_node<typename node_of<L>::type, typename node_of<R>::type> operator*(const L &l, const R &r)
+    {
+      return {as_node(l), as_node(r)};
+    }
+
+    template<typename L, typename R, typename = typename enable_operands<L, R>::type>
+    residue_node<typename node_of<L>::type, typename node_of<R>::type> operator%(const L &l, const R &r)
+    {
+      return {as_node(l), as_node(r)};
+    }
+
+    template<typename E, typename = typename std::enable_if<is_node<E>::value>::type>
+    shift_node<E> operator<<(const E &e, int bits)
+    {
+      return {e, bits};
+    }
+
+    /* Evaluation: expressions referring to the destination are evaluated into a temporary */
+    template<typename E, typename = typename std::enable_if<is_node<E>::value>::type>
+    big_integer & assign(big_integer &dest, const E &e)
+    {
+      if (!e.refers_to(dest))
+      {
+        e.assign_to(dest);
+        return dest;
+      }
+      big_integer res;
+      e.assign_to(res);
+      return dest = std::move(res);
+    }
+
+    template<typename E, typename = typename std::enable_if<is_node<E>::value>::type>
+    big_integer & add_assign(big_integer &dest, const E &e)
+    {
+      if (e.refers_to(dest))
+        return dest += big_integer(e);
+      e.add_to(dest, false);
+      return dest;
+    }
+
+    template<typename E, typename = typename std::enable_if<is_node<E>::value>::type>
+    big_integer & sub_assign(big_integer &dest, const E &e)
+    {
+      if (e.refers_to(dest))
+        return dest -= big_integer(e);
+      e.add_to(dest, true);
+      return dest;
+    }
+  } // end of 'expr' namespace
+} // end of 'big_int_util' namespace
+
+#endif // EXPRESSION_H
@@ -0,0 +1,478 @@
+/* Nikolai Kholiavin, M3138 */
+
+#ifndef FIXED_INTEGER_H
+#define FIXED_INTEGER_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "big_integer.h"
+#include "limb_arithmetic.h"
+
+// operations are constant expressions where places in std::array can be modified in them (C++17)
+#if __cplusplus >= 201703L
+#define BIGINT_FIXED_CONSTEXPR constexpr
+#else
+#define BIGINT_FIXED_CONSTEXPR inline
+#endif
+
+// loops over all places (up to 16 of them) are unrolled
+#if defined(__clang__)
+#define BIGINT_FIXED_UNROLL _Pragma("unroll 16")
+#elif defined(__GNUC__) && __GNUC__ >= 8
+#define BIGINT_FIXED_UNROLL _Pragma("GCC unroll 16")
+#else
+#define BIGINT_FIXED_UNROLL
+#endif
+
+/***
+ * Integer of Bits bits, 2's complement if Signed: places are stored inside of the number
+ * (no allocation, sharing or normalization), loops over them have constant length.
+ * Results are taken modulo 2^Bits as with built-in unsigned integers (so signed ones wrap too),
+ * division rounds toward zero (std::invalid_argument is thrown for zero divisor).
+ ***/
+template<size_t Bits, bool Signed = true>
+struct fixed_integer
+{
+  static_assert(Bits > 0, "fixed_integer: no bits");
+
+private:
+  using place_t = big_int_util::place_t;
+  static constexpr int PLACE_BITS = big_int_util::PLACE_BITS;
+  static constexpr place_t MAX_PLACE = std::numeric_limits<place_t>::max();
+
+public:
+  static constexpr size_t PLACES = (Bits + PLACE_BITS - 1) / PLACE_BITS;
+  using places_t = std::array<place_t, PLACES>;
+
+private:
+  // bits of the last place above Bits
+  static constexpr int SPARE_BITS = static_cast<int>(PLACES * PLACE_BITS - Bits);
+
+  // invariant: spare bits are copies of the sign bit (zeros if unsigned)
+  places_t data{};
+
+public:
+  BIGINT_FIXED_CONSTEXPR fixed_integer() = default;
+
+  // built-in integers are sign-extended
+  template<typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+  BIGINT_FIXED_CONSTEXPR fixed_integer(T a)
+  {
+    // conversion to uint64_t sign-extends signed types
+    uint64_t bits = static_cast<uint64_t>(a);
+    place_t fill = std::is_signed<T>::value && a < 0 ? MAX_PLACE : 0;
+    for (size_t i = 0; i < PLACES; i++)
+      data[i] = i * PLACE_BITS < 64 ? static_cast<place_t>(bits >> (i * PLACE_BITS % 64)) : fill;
+    normalize();
+  }
+
+  // truncated or extended by the sign of other
+  template<size_t OtherBits, bool OtherSigned>
+  BIGINT_FIXED_CONSTEXPR explicit fixed_integer(const fixed_integer<OtherBits, OtherSigned> &other)
+  {
+    const auto &places = other.places();
+    place_t fill = other.is_negative() ? MAX_PLACE : 0;
+    for (size_t i = 0; i < PLACES; i++)
+      data[i] = i < places.size() ? places[i] : fill;
+    normalize();
+  }
+
+  // a modulo 2^Bits
+  explicit fixed_integer(const big_integer &a)
+  {
+    place_view places = a.places();
+    place_t fill = places.size != 0 && places.data[places.size - 1] >> (PLACE_BITS - 1) ? MAX_PLACE : 0;
+    for (size_t i = 0; i < PLACES; i++)
+      data[i] = i < places.size ? places.data[i] : fill;
+    normalize();
+  }
+
+  explicit operator big_integer() const
+  {
+    big_integer res;
+    // spare place holds the sign of unsigned numbers
+    res.resize(PLACES + 1);
+    place_t *places = res.data.data();
+    for (size_t i = 0; i < PLACES; i++)
+      places[i] = data[i];
+    places[PLACES] = is_negative() ? MAX_PLACE : 0;
+    res.shrink();
+    return res;
+  }
+
+  // little-endian places, the last one is sign-extended (zero-extended if unsigned)
+  BIGINT_FIXED_CONSTEXPR const places_t & places() const
+  {
+    return data;
+  }
+
+  BIGINT_FIXED_CONSTEXPR bool is_negative() const
+  {
+    return Signed && data[PLACES - 1] >> (PLACE_BITS - 1);
+  }
+
+  BIGINT_FIXED_CONSTEXPR fixed_integer & operator+=(const fixed_integer &rhs)
+  {
+    place_t carry = 0;
+    BIGINT_FIXED_UNROLL
+    for (size_t i = 0; i < PLACES; i++)
+      data[i] = big_int_util::add_places(data[i], rhs.data[i], carry);
+    return normalize();
+  }
+
+  BIGINT_FIXED_CONSTEXPR fixed_integer & operator-=(const fixed_integer &rhs)
+  {
+    place_t borrow = 0;
+    BIGINT_FIXED_UNROLL
+    for (size_t i = 0; i < PLACES; i++)
+      data[i] = big_int_util::sub_places(data[i], rhs.data[i], borrow);
+    return normalize();
+  }
+
+  // low half of the product: the same for 2's complement and unsigned numbers
+  BIGINT_FIXED_CONSTEXPR fixed_integer & operator*=(const fixed_integer &rhs)
+  {
+    places_t res{};
+    BIGINT_FIXED_UNROLL
+    for (size_t i = 0; i < PLACES; i++)
+    {
+      place_t carry = 0;
+      BIGINT_FIXED_UNROLL
+      for (size_t j = 0; i + j < PLACES; j++)
+        res[i + j] = big_int_util::mul_add_places(data[i], rhs.data[j], res[i + j], carry, carry);
+    }
+    data = res;
+    return normalize();
+  }
+
+  BIGINT_FIXED_CONSTEXPR fixed_integer & operator/=(const fixed_integer &rhs)
+  {
+    fixed_integer rem;
+    return divide(rhs, rem);
+  }
+
+  BIGINT_FIXED_CONSTEXPR fixed_integer & operator%=(const fixed_integer &rhs)
+  {
+    fixed_integer rem;
+    divide(rhs, rem);
+    return *this = rem;
+  }
+
+  BIGINT_FIXED_CONSTEXPR fixed_integer & operator&=(const fixed_integer &rhs)
+  {
+    BIGINT_FIXED_UNROLL
+    for (size_t i = 0; i < PLACES; i++)
+      data[i] &= rhs.data[i];
+    return *this;
+  }
+
+  BIGINT_FIXED_CONSTEXPR fixed_integer & operator|=(const fixed_integer &rhs)
+  {
+    BIGINT_FIXED_UNROLL
+    for (size_t i = 0; i < PLACES; i++)
+      data[i] |= rhs.data[i];
+    return *this;
+  }
+
+  BIGINT_FIXED_CONSTEXPR fixed_integer & operator^=(const fixed_integer &rhs)
+  {
+    BIGINT_FIXED_UNROLL
+    for (size_t i = 0; i < PLACES; i++)
+      data[i] ^= rhs.data[i];
+    return *this;
+  }
+
+  // negative rhs shifts in the other direction, right shift of signed numbers is arithmetic
+  BIGINT_FIXED_CONSTEXPR fixed_integer & operator<<=(int rhs)
+  {
+    return rhs < 0 ? shift_right(-static_cast<int64_t>(rhs)) : shift_left(rhs);
+  }
+
+  BIGINT_FIXED_CONSTEXPR fixed_integer & operator>>=(int rhs)
+  {
+    return rhs < 0 ? shift_left(-static_cast<int64_t>(rhs)) : shift_right(rhs);
+  }
+
+  BIGINT_FIXED_CONSTEXPR fixed_integer operator+() const
+  {
+    return *this;
+  }
+
+  BIGINT_FIXED_CONSTEXPR fixed_integer operator-() const
+  {
+    fixed_integer res;
+    return res -= *this;
+  }
+
+  BIGINT_FIXED_CONSTEXPR fixed_integer operator~() const
+  {
+    fixed_integer res;
+    BIGINT_FIXED_UNROLL
+    for (size_t i = 0; i < PLACES; i++)
+      res.data[i] = ~data[i];
+    return res.normalize();
+  }
+
+  BIGINT_FIXED_CONSTEXPR fixed_integer & operator++()
+  {
+    return *this += 1;
+  }
+
+  BIGINT_FIXED_CONSTEXPR fixed_integer operator++(int)
+  {
+    fixed_integer res = *this;
+    ++*this;
+    return res;
+  }
+
+  BIGINT_FIXED_CONSTEXPR fixed_integer & operator--()
+  {
+    return *this -= 1;
+  }
+
+  BIGINT_FIXED_CONSTEXPR fixed_integer operator--(int)
+  {
+    fixed_integer res = *this;
+    --*this;
+    return res;
+  }
+
+  /* Operators are found by ADL, so built-in integers are converted on either side */
+  friend BIGINT_FIXED_CONSTEXPR fixed_integer operator+(fixed_integer a, const fixed_integer &b)
+  {
+    return a += b;
+  }
+
+  friend BIGINT_FIXED_CONSTEXPR fixed_integer operator-(fixed_integer a, const fixed_integer &b)
+  {
+    return a -= b;
+  }
+
+  friend BIGINT_FIXED_CONSTEXPR fixed_integer operator*(fixed_integer a, const fixed_integer &b)
+  {
+    return a *= b;
+  }
+
+  friend BIGINT_FIXED_CONSTEXPR fixed_integer operator/(fixed_integer a, const fixed_integer &b)
+  {
+    return a /= b;
+  }
+
+  friend BIGINT_FIXED_CONSTEXPR fixed_integer operator%(fixed_integer a, const fixed_integer &b)
+  {
+    return a %= b;
+  }
+
+  friend BIGINT_FIXED_CONSTEXPR fixed_integer operator&(fixed_integer a, const fixed_integer &b)
+  {
+    return a &= b;
+  }
+
+  friend BIGINT_FIXED_CONSTEXPR fixed_integer operator|(fixed_integer a, const fixed_integer &b)
+  {
+    return a |= b;
+  }
+
+  friend BIGINT_FIXED_CONSTEXPR fixed_integer operator^(fixed_integer a, const fixed_integer &b)
+  {
+    return a ^= b;
+  }
+
+  friend BIGINT_FIXED_CONSTEXPR fixed_integer operator<<(fixed_integer a, int b)
+  {
+    return a <<= b;
+  }
+
+  friend BIGINT_FIXED_CONSTEXPR fixed_integer operator>>(fixed_integer a, int b)
+  {
+    return a >>= b;
+  }
+
+  friend BIGINT_FIXED_CONSTEXPR bool operator==(const fixed_integer &a, const fixed_integer &b)
+  {
+    BIGINT_FIXED_UNROLL
+    for (size_t i = 0; i < PLACES; i++)
+      if (a.data[i] != b.data[i])
+        return false;
+    return true;
+  }
+
+  friend BIGINT_FIXED_CONSTEXPR bool operator!=(const fixed_integer &a, const fixed_integer &b)
+  {
+    return !(a == b);
+  }
+
+  friend BIGINT_FIXED_CONSTEXPR bool operator<(const fixed_integer &a, const fixed_integer &b)
+  {
+    return compare(a, b) < 0;
+  }
+
+  friend BIGINT_FIXED_CONSTEXPR bool operator>(const fixed_integer &a, const fixed_integer &b)
+  {
+    return compare(a, b) > 0;
+  }
+
+  friend BIGINT_FIXED_CONSTEXPR bool operator<=(const fixed_integer &a, const fixed_integer &b)
+  {
+    return compare(a, b) <= 0;
+  }
+
+  friend BIGINT_FIXED_CONSTEXPR bool operator>=(const fixed_integer &a, const fixed_integer &b)
+  {
+    return compare(a, b) >= 0;
+  }
+
+private:
+  // masks or sign-extends spare bits of the last place
+  BIGINT_FIXED_CONSTEXPR fixed_integer & normalize()
+  {
+    constexpr place_t spare_mask = ~(MAX_PLACE >> SPARE_BITS);
+    place_t &last = data[PLACES - 1];
+    if (Signed && (last >> (PLACE_BITS - 1 - SPARE_BITS) & 1))
+      last |= spare_mask;
+    else
+      last &= ~spare_mask;
+    return *this;
+  }
+
+  static BIGINT_FIXED_CONSTEXPR int compare(const fixed_integer &a, const fixed_integer &b)
+  {
+    // numbers of the same sign are ordered as their unsigned places
+    if (a.is_negative() != b.is_negative())
+      return a.is_negative() ? -1 : 1;
+    BIGINT_FIXED_UNROLL
+    for (size_t i = PLACES; i > 0; i--)
+      if (a.data[i - 1] != b.data[i - 1])
+        return a.data[i - 1] > b.data[i - 1] ? 1 : -1;
+    return 0;
+  }
+
+  BIGINT_FIXED_CONSTEXPR fixed_integer & shift_left(int64_t bits)
+  {
+    size_t places = static_cast<size_t>(std::min<int64_t>(bits / PLACE_BITS, PLACES));
+    int rest = static_cast<int>(bits % PLACE_BITS);
+    BIGINT_FIXED_UNROLL
+    for (size_t i = PLACES; i > 0; i--)
+    {
+      size_t from = i - 1 - places;
+      place_t high = i - 1 >= places ? data[from] : 0, low = i - 1 > places ? data[from - 1] : 0;
+      data[i - 1] = rest == 0 ? high : high << rest | low >> (PLACE_BITS - rest);
+    }
+    return normalize();
+  }
+
+  BIGINT_FIXED_CONSTEXPR fixed_integer & shift_right(int64_t bits)
+  {
+    size_t places = static_cast<size_t>(std::min<int64_t>(bits / PLACE_BITS, PLACES));
+    int rest = static_cast<int>(bits % PLACE_BITS);
+    place_t fill = is_negative() ? MAX_PLACE : 0;
+    BIGINT_FIXED_UNROLL
+    for (size_t i = 0; i < PLACES; i++)
+    {
+      size_t from = i + places;
+      place_t low = from < PLACES ? data[from] : fill, high = from + 1 < PLACES ? data[from + 1] : fill;
+      data[i] = rest == 0 ? low : low >> rest | high << (PLACE_BITS - rest);
+    }
+    return *this;
+  }
+
+  // absolute value as unsigned places (it fits into them, spare bits included)
+  static BIGINT_FIXED_CONSTEXPR places_t magnitude(const fixed_integer &a)
+  {
+    if (!a.is_negative())
+      return a.data;
+    places_t res{};
+    place_t borrow = 0;
+    for (size_t i = 0; i < PLACES; i++)
+      res[i] = big_int_util::sub_places(0, a.data[i], borrow);
+    return res;
+  }
+
+  // *this /= rhs, rem = *this % rhs (with the sign of the dividend)
+  BIGINT_FIXED_CONSTEXPR fixed_integer & divide(const fixed_integer &rhs, fixed_integer &rem)
+  {
+    if (rhs == 0)
+      throw std::invalid_argument("fixed_integer: division by zero");
+    bool negative = is_negative(), rhs_negative = rhs.is_negative();
+    divide_unsigned(magnitude(*this), magnitude(rhs), data, rem.data);
+    // the only overflow, min / -1, wraps here
+    normalize();
+    rem.normalize();
+    if (negative != rhs_negative)
+      *this = -*this;
+    if (negative)
+      rem = -rem;
+    return *this;
+  }
+
+  // Knuth's algorithm D on unsigned places: q = a / b, r = a % b, b != 0
+  static BIGINT_FIXED_CONSTEXPR void divide_unsigned(const places_t &a, const places_t &b, places_t &q, places_t &r)
+  {
+    using namespace big_int_util;
+    size_t an = PLACES, bn = PLACES;
+    while (an > 0 && a[an - 1] == 0)
+      an--;
+    while (b[bn - 1] == 0)
+      bn--;
+    q = places_t{};
+    if (an < bn)
+    {
+      r = a;
+      return;
+    }
+
+    // normalized divisor d and dividend u with a place for bits shifted out
+    int shift = leading_zeros(b[bn - 1]);
+    places_t d{};
+    std::array<place_t, PLACES + 1> u{};
+    for (size_t i = 0; i < PLACES; i++)
+    {
+      d[i] = shift == 0 ? b[i] : b[i] << shift | (i > 0 ? b[i - 1] >> (PLACE_BITS - shift) : 0);
+      u[i] = shift == 0 ? a[i] : a[i] << shift | (i > 0 ? a[i - 1] >> (PLACE_BITS - shift) : 0);
+    }
+    u[PLACES] = shift == 0 ? 0 : a[PLACES - 1] >> (PLACE_BITS - shift);
+
+    place_t d1 = d[bn - 1], d0 = bn >= 2 ? d[bn - 2] : 0, v = reciprocal(d1);
+    for (size_t j = an - bn + 1; j-- > 0;)
+    {
+      place_t n2 = u[j + bn];
+      place_t qt = div_3_2_estimate(n2, u[j + bn - 1], bn >= 2 ? u[j + bn - 2] : 0, d1, d0, v);
+      if (n2 < submul_1(u.data() + j, d.data(), bn, qt))
+      {
+        // wrong, correct estimate
+        qt--;
+        place_t carry = 0;
+        for (size_t i = 0; i < bn; i++)
+          u[j + i] = add_places(u[j + i], d[i], carry);
+      }
+      u[j + bn] = 0;
+      q[j] = qt;
+    }
+
+    r = places_t{};
+    for (size_t i = 0; i < bn; i++)
+      r[i] = shift == 0 ? u[i] : u[i] >> shift | u[i + 1] << (PLACE_BITS - shift);
+  }
+};
+
+template<size_t Bits, bool Signed>
+std::string to_string(const fixed_integer<Bits, Signed> &a, int base = 10)
+{
+  return to_string(big_integer(a), base);
+}
+
+template<size_t Bits, bool Signed>
+std::ostream & operator<<(std::ostream &s, const fixed_integer<Bits, Signed> &a)
+{
+  return s << to_string(a);
+}
+
+#endif // FIXED_INTEGER_H
@@ -0,0 +1,232 @@
+/* Nikolai Kholiavin, M3138 */
+
+#include <vector>
+
+#include "gcd.h"
+#include "multiplication.h"
+#include "division.h"
+
+namespace big_int_util
+{
+  namespace
+  {
+    // bits of approximations: their sums with matrix entries fit into a place
+    constexpr size_t APPROX_BITS = PLACE_BITS - 2;
+
+    // floor(x[0..n) / 2^k), must fit into a place
+    place_t bits_at(const place_t *x, size_t n, size_t k)
+    {
+      size_t w = k / PLACE_BITS;
+      int off = static_cast<int>(k % PLACE_BITS);
+      place_t res = x[w] >> off;
+      if (off != 0 && w + 1 < n)
+        res |= x[w + 1] << (PLACE_BITS - off);
+      return res;
+    }
+
+    // Euclid's steps (u, v) -> (a * u + b * v, c * u + d * v) as absolute values of entries:
+    // a, d >= 0 >= b, c after an even number of steps, the opposite after an odd one
+    struct lehmer_matrix
+    {
+      place_t a, b, c, d;
+      size_t steps;
+    };
+
+    // Knuth's algorithm L on approximations x >= y of APPROX_BITS bits:
+    // steps are taken while quotients of both bounds of the true ones coincide
+    lehmer_matrix lehmer_step(place_t x, place_t y)
+    {
+      // entries are kept modulo B, their true values are signed and at most 2^APPROX_BITS
+      place_t a = 1, b = 0, c = 0, d = 1;
+      size_t steps = 0;
+      while (y + c != 0 && y + d != 0)
+      {
+        place_t q = (x + a) / (y + c);
+        if (q != (x + b) / (y + d))
+          break;
+        place_t t = a - q * c;
+        a = c;
+        c = t;
+        t = b - q * d;
+        b = d;
+        d = t;
+        t = x - q * y;
+        x = y;
+        y = t;
+        steps++;
+      }
+      if (steps % 2 == 0)
+        return {a, static_cast<place_t>(-b), static_cast<place_t>(-c), d, steps};
+      return {static_cast<place_t>(-a), b, c, static_cast<place_t>(-d), steps};
+    }
+
+    // res[0..n) = px * x[0..n) - ny * y[0..n), the difference must be non-negative and fit into n places
+    void combine(place_t *res, const place_t *x, place_t px, const place_t *y, place_t ny, size_t n)
+    {
+      mul_1(res, x, n, px);
+      submul_1(res, y, n, ny);
+    }
+
+    // res[0..n] = px * x[0..n) + py * y[0..n)
+    void combine_abs(place_t *res, const place_t *x, place_t px, const place_t *y, place_t py, size_t n)
+    {
+      res[n] = mul_1(res, x, n, px);
+      res[n] += addmul_1(res, y, n, py);
+    }
+
+    /***
+     * Remainder sequence u >= v, started from (a, b), with optional cofactors of a:
+     * u = su * a, v = sv * a (mod b), su has sign 'su_negative', sv has the opposite one.
+     * All buffers are allocated once, u and v are valid on [0..un), su and sv on [0..sn).
+     ***/
+    class remainder_sequence
+    {
+    private:
+      std::vector<place_t> u, v, tu, tv, q;
+      size_t un, vn;
+      bool cofactors;
+      std::vector<place_t> su, sv, tsu, tsv, prod;
+      size_t sn = 1;
+      bool su_negative = false;
+
+      void swap_uv()
+      {
+        std::swap(u, v);
+        std::swap(un, vn);
+        if (cofactors)
+        {
+          std::swap(su, sv);
+          su_negative = !su_negative;
+        }
+      }
+
+      // (u, v) -> (v, u mod v)
+      void division_step()
+      {
+        size_t qn = un - vn + 1;
+        div_qr(q.data(), tu.data(), u.data(), un, v.data(), vn);
+        std::swap(u, v);
+        std::swap(v, tu);
+        un = vn;
+        vn = normalized_size(v.data(), un);
+        if (!cofactors)
+          return;
+
+        // sv = su + q * sv in absolute values (they have opposite signs)
+        qn = normalized_size(q.data(), qn);
+        size_t pn = 0;
+        if (qn != 0)
+        {
+          mul(prod.data(), q.data(), qn, sv.data(), sn);
+          pn = normalized_size(prod.data(), qn + sn);
+        }
+        size_t len = std::max(pn, sn);
+        std::copy_n(prod.data(), pn, tsv.data());
+        std::fill(tsv.data() + pn, tsv.data() + len + 1, 0);
+        tsv[len] = add(tsv.data(), tsv.data(), len, su.data(), sn);
+        std::swap(su, sv);
+        std::swap(sv, tsv);
+        su_negative = !su_negative;
+        size_t new_sn = std::max(sn, normalized_size(sv.data(), len + 1));
+        std::fill(su.data() + sn, su.data() + new_sn, 0);
+        sn = new_sn;
+      }
+
+      // applies Lehmer's matrix, returns false if it has no steps
+      bool lehmer_update()
+      {
+        size_t bits = un * PLACE_BITS - leading_zeros(u[un - 1]);
+        size_t k = bits > APPROX_BITS ? bits - APPROX_BITS : 0;
+        lehmer_matrix m = lehmer_step(bits_at(u.data(), un, k), bits_at(v.data(), un, k));
+        if (m.steps == 0)
+          return false;
+
+        // v is zero on [vn..un)
+        bool odd = m.steps % 2 == 1;
+        if (odd)
+        {
+          combine(tu.data(), v.data(), m.b, u.data(), m.a, un);
+          combine(tv.data(), u.data(), m.c, v.data(), m.d, un);
+        }
+        else
+        {
+          combine(tu.data(), u.data(), m.a, v.data(), m.b, un);
+          combine(tv.data(), v.data(), m.d, u.data(), m.c, un);
+        }
+        std::swap(u, tu);
+        std::swap(v, tv);
+        un = normalized_size(u.data(), un);
+        vn = normalized_size(v.data(), un);
+
+        if (cofactors)
+        {
+          // products of entries and cofactors in each sum have the same sign
+          combine_abs(tsu.data(), su.data(), m.a, sv.data(), m.b, sn);
+          combine_abs(tsv.data(), su.data(), m.c, sv.data(), m.d, sn);
+          std::swap(su, tsu);
+          std::swap(sv, tsv);
+          sn = std::max(normalized_size(su.data(), sn + 1), normalized_size(sv.data(), sn + 1));
+          su_negative ^= odd;
+        }
+        return true;
+      }
+
+    public:
+      remainder_sequence(const place_t *a, size_t an, const place_t *b, size_t bn, bool cofactors)
+        : u(a, a + an), v(std::max(an, bn), 0), tu(v.size()), tv(v.size()), q(v.size() + 1),
+          un(an), vn(bn), cofactors(cofactors)
+      {
+        u.resize(v.size(), 0);
+        std::copy_n(b, bn, v.data());
+        if (cofactors)
+        {
+          // cofactors are at most b, so they fit into bn places with a carry
+          su.assign(bn + 1, 0);
+          sv.assign(bn + 1, 0);
+          tsu.resize(bn + 1);
+          tsv.resize(bn + 1);
+          prod.resize(an + bn + 1);
+          su[0] = 1;
+        }
+        if (un < vn || (un == vn && cmp_n(u.data(), v.data(), un) < 0))
+          swap_uv();
+      }
+
+      size_t run()
+      {
+        while (vn != 0)
+          if (!lehmer_update())
+            division_step();
+        return un;
+      }
+
+      void result(place_t *g, place_t *s, bool &s_negative) const
+      {
+        std::copy_n(u.data(), un, g);
+        if (s != nullptr)
+        {
+          std::copy_n(su.data(), std::min(sn, su.size() - 1), s);
+          std::fill(s + std::min(sn, su.size() - 1), s + su.size() - 1, 0);
+          s_negative = su_negative;
+        }
+      }
+    };
+  }
+
+  size_t gcd(place_t *g, const place_t *a, size_t an, const place_t *b, size_t bn)
+  {
+    remainder_sequence seq(a, an, b, bn, false);
+    size_t gn = seq.run();
+    bool unused;
+    seq.result(g, nullptr, unused);
+    return gn;
+  }
+
+  size_t gcdext(place_t *g, place_t *s, bool &s_negative, const place_t *a, size_t an, const place_t *b, size_t bn)
+  {
+    remainder_sequence seq(a, an, b, bn, true);
+    size_t gn = seq.run();
+    seq.result(g, s, s_negative);
+    return gn;
+  }
+} // end of 'big_int_util' namespace
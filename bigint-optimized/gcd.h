@@ -0,0 +1,25 @@
+/* Nikolai Kholiavin, M3138 */
+
+#ifndef GCD_H
+#define GCD_H
+
+#include "limb_arithmetic.h"
+
+namespace big_int_util
+{
+  /***
+   * Lehmer's greatest common divisor: Euclid's steps are simulated on single-place
+   * approximations (leading bits) and applied to whole numbers at once, full division
+   * is done only when a quotient does not fit into a place.
+   * Operands are a[0..an), b[0..bn), an, bn > 0, a[an - 1] != 0, b[bn - 1] != 0.
+   ***/
+
+  // g[0..min(an, bn)) = gcd(a, b), returns its size without leading zero places
+  size_t gcd(place_t *g, const place_t *a, size_t an, const place_t *b, size_t bn);
+
+  // the same, s[0..bn) gets the absolute value of cofactor s, a * s = g (mod b), |s| <= b / g,
+  // its sign is stored to s_negative
+  size_t gcdext(place_t *g, place_t *s, bool &s_negative, const place_t *a, size_t an, const place_t *b, size_t bn);
+} // end of 'big_int_util' namespace
+
+#endif // GCD_H
@@ -0,0 +1,40 @@
+/* Nikolai Kholiavin, M3138 */
+
+#include "instrumentation.h"
+
+namespace big_int_util
+{
+#ifdef BIGINT_INSTRUMENTATION
+  thread_local instrumentation::counters instrumentation::current = {};
+#endif
+
+  const char * instrumentation::operation_name(operation op)
+  {
+    static const char *names[OPERATIONS] =
+    {
+      "add", "sub", "mul", "div", "mod",
+      "and", "or", "xor", "not", "negate", "shift",
+      "compare", "to_string", "from_string"
+    };
+    return names[op];
+  }
+
+  instrumentation::counters instrumentation::snapshot()
+  {
+#ifdef BIGINT_INSTRUMENTATION
+    counters res = current;
+#else
+    counters res = {};
+#endif
+    res.pool = place_pool::get_statistics();
+    return res;
+  }
+
+  void instrumentation::reset()
+  {
+#ifdef BIGINT_INSTRUMENTATION
+    current = counters{};
+#endif
+    place_pool::reset_statistics();
+  }
+} // end of 'big_int_util' namespace
@@ -0,0 +1,82 @@
+/* Nikolai Kholiavin, M3138 */
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <cstddef>
+
+#include "place_pool.h"
+
+namespace big_int_util
+{
+  /***
+   * Hot-path counters, compiled in only if BIGINT_INSTRUMENTATION is defined
+   * (otherwise all counting functions are empty and snapshots are zero).
+   * Counters are per thread: a snapshot has counts of the calling thread.
+   ***/
+  namespace instrumentation
+  {
+    // histogram buckets by size in places: bucket k counts sizes in [2^k, 2^(k + 1)), 0 is in bucket 0
+    static constexpr size_t SIZE_BUCKETS = 24;
+
+    enum operation
+    {
+      op_add, op_sub, op_mul, op_div, op_mod,
+      op_and, op_or, op_xor, op_not, op_negate, op_shift,
+      op_compare, op_to_string, op_from_string,
+      OPERATIONS
+    };
+
+    const char * operation_name(operation op);
+
+    struct counters
+    {
+      // shared buffers allocated and freed, by capacity
+      size_t allocations[SIZE_BUCKETS];
+      size_t frees[SIZE_BUCKETS];
+      // copies of shared places before a write (copy-on-write) and reallocations for growth
+      size_t cow_copies, growth_copies;
+      // inline places moved to an allocated buffer
+      size_t static_to_dynamic;
+      // places removed by normalization and places pushed to fix the sign
+      size_t shrunk_places, sign_places;
+      // calls by the size of the larger operand
+      size_t operations[OPERATIONS][SIZE_BUCKETS];
+      // block pool allocations (always counted, see place_pool.h)
+      place_pool::statistics pool;
+    };
+
+    inline size_t size_bucket(size_t n)
+    {
+      size_t bucket = 0;
+      for (; n > 1 && bucket + 1 < SIZE_BUCKETS; n >>= 1)
+        bucket++;
+      return bucket;
+    }
+
+    counters snapshot();
+    void reset();
+
+#ifdef BIGINT_INSTRUMENTATION
+    extern thread_local counters current;
+
+    inline void count_allocation(size_t capacity) { current.allocations[size_bucket(capacity)]++; }
+    inline void count_free(size_t capacity) { current.frees[size_bucket(capacity)]++; }
+    inline void count_copy(bool cow) { (cow ? current.cow_copies : current.growth_copies)++; }
+    inline void count_static_to_dynamic() { current.static_to_dynamic++; }
+    inline void count_shrink(size_t places) { current.shrunk_places += places; }
+    inline void count_sign_place() { current.sign_places++; }
+    inline void count_operation(operation op, size_t places) { current.operations[op][size_bucket(places)]++; }
+#else
+    inline void count_allocation(size_t) {}
+    inline void count_free(size_t) {}
+    inline void count_copy(bool) {}
+    inline void count_static_to_dynamic() {}
+    inline void count_shrink(size_t) {}
+    inline void count_sign_place() {}
+    inline void count_operation(operation, size_t) {}
+#endif
+  } // end of 'instrumentation' namespace
+} // end of 'big_int_util' namespace
+
+#endif // INSTRUMENTATION_H
@@ -0,0 +1,400 @@
+/* Nikolai Kholiavin, M3138 */
+
+#ifndef LIMB_ARITHMETIC_H
+#define LIMB_ARITHMETIC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+
+// place width in bits: 32 (portable) or 64 (requires unsigned __int128)
+#ifndef BIGINT_PLACE_BITS
+#define BIGINT_PLACE_BITS 32
+#endif
+
+// BIGINT_ASM_LIMBS: add, sub, mul and addmul loops are taken from the asm kernels (asm/limbs.h)
+#ifdef BIGINT_ASM_LIMBS
+#if BIGINT_PLACE_BITS != 64
+#error BIGINT_ASM_LIMBS requires BIGINT_PLACE_BITS == 64
+#endif
+#include "limbs.h"
+#endif
+
+// place helpers are constant expressions where loops are allowed in them (C++14)
+#if __cplusplus >= 201402L
+#define BIGINT_CONSTEXPR14 constexpr
+#else
+#define BIGINT_CONSTEXPR14 inline
+#endif
+
+namespace big_int_util
+{
+  /* Place (limb) type and its double-width counterpart */
+#if BIGINT_PLACE_BITS == 64
+  using place_t = uint64_t;
+  __extension__ typedef unsigned __int128 double_place_t;
+#elif BIGINT_PLACE_BITS == 32
+  using place_t = uint32_t;
+  using double_place_t = uint64_t;
+#else
+#error BIGINT_PLACE_BITS must be 32 or 64
+#endif
+  static constexpr int PLACE_BITS = std::numeric_limits<place_t>::digits;
+
+  /* Single place steps of the loops below */
+
+  // a + b + carry, carry (0 or 1) is updated
+  BIGINT_CONSTEXPR14 place_t add_places(place_t a, place_t b, place_t &carry)
+  {
+    double_place_t s = double_place_t{a} + b + carry;
+    carry = static_cast<place_t>(s >> PLACE_BITS);
+    return static_cast<place_t>(s);
+  }
+
+  // a - b - borrow, borrow (0 or 1) is updated
+  BIGINT_CONSTEXPR14 place_t sub_places(place_t a, place_t b, place_t &borrow)
+  {
+    double_place_t d = double_place_t{a} - b - borrow;
+    borrow = static_cast<place_t>(d >> PLACE_BITS) & 1;
+    return static_cast<place_t>(d);
+  }
+
+  // a * b + c + d (it always fits into a double place), its high place is stored to high
+  BIGINT_CONSTEXPR14 place_t mul_add_places(place_t a, place_t b, place_t c, place_t d, place_t &high)
+  {
+    double_place_t p = double_place_t{a} * b + c + d;
+    high = static_cast<place_t>(p >> PLACE_BITS);
+    return static_cast<place_t>(p);
+  }
+
+  /***
+   * Primitive loops over unsigned place arrays (lowest place first).
+   * Destination may coincide with a source operand if it starts at the same place.
+   ***/
+
+  // res[0..n) = a[0..n) + b[0..n), returns carry
+  inline place_t add_n(place_t *res, const place_t *a, const place_t *b, size_t n)
+  {
+#ifdef BIGINT_ASM_LIMBS
+    return asm_add_long_long(res, a, b, n);
+#else
+    place_t carry = 0;
+    for (size_t i = 0; i < n; i++)
+      res[i] = add_places(a[i], b[i], carry);
+    return carry;
+#endif
+  }
+
+  // res[0..n) = a[0..n) + b, returns carry
+  inline place_t add_1(place_t *res, const place_t *a, size_t n, place_t b)
+  {
+    size_t i = 0;
+    for (; i < n && b != 0; i++)
+    {
+      res[i] = a[i] + b;
+      b = res[i] < b;
+    }
+    if (res != a)
+      std::copy(a + i, a + n, res + i);
+    return b;
+  }
+
+  // res[0..an) = a[0..an) + b[0..bn), an >= bn, returns carry
+  inline place_t add(place_t *res, const place_t *a, size_t an, const place_t *b, size_t bn)
+  {
+    return add_1(res + bn, a + bn, an - bn, add_n(res, a, b, bn));
+  }
+
+  // res[0..n) = a[0..n) - b[0..n), returns borrow
+  inline place_t sub_n(place_t *res, const place_t *a, const place_t *b, size_t n)
+  {
+#ifdef BIGINT_ASM_LIMBS
+    return asm_sub_long_long(res, a, b, n);
+#else
+    place_t borrow = 0;
+    for (size_t i = 0; i < n; i++)
+      res[i] = sub_places(a[i], b[i], borrow);
+    return borrow;
+#endif
+  }
+
+  // res[0..n) = a[0..n) - b, returns borrow
+  inline place_t sub_1(place_t *res, const place_t *a, size_t n, place_t b)
+  {
+    size_t i = 0;
+    for (; i < n && b != 0; i++)
+    {
+      place_t ai = a[i];
+      res[i] = ai - b;
+      b = ai < b;
+    }
+    if (res != a)
+      std::copy(a + i, a + n, res + i);
+    return b;
+  }
+
+  // res[0..an) = a[0..an) - b[0..bn), an >= bn, returns borrow
+  inline place_t sub(place_t *res, const place_t *a, size_t an, const place_t *b, size_t bn)
+  {
+    return sub_1(res + bn, a + bn, an - bn, sub_n(res, a, b, bn));
+  }
+
+  // res[0..n) = -a[0..n) modulo 2^(n * PLACE_BITS), returns true if a is non-zero
+  inline bool neg_n(place_t *res, const place_t *a, size_t n)
+  {
+    size_t i = 0;
+    for (; i < n && a[i] == 0; i++)
+      res[i] = 0;
+    if (i == n)
+      return false;
+    res[i] = ~a[i] + 1;
+    for (i++; i < n; i++)
+      res[i] = ~a[i];
+    return true;
+  }
+
+  // res[0..n) = a[0..n) * b, returns high place
+  inline place_t mul_1(place_t *res, const place_t *a, size_t n, place_t b)
+  {
+#ifdef BIGINT_ASM_LIMBS
+    return asm_mul_long_short(res, a, n, b);
+#else
+    place_t carry = 0;
+    for (size_t i = 0; i < n; i++)
+      res[i] = mul_add_places(a[i], b, carry, 0, carry);
+    return carry;
+#endif
+  }
+
+  // res[0..n) += a[0..n) * b, returns high place
+  inline place_t addmul_1(place_t *res, const place_t *a, size_t n, place_t b)
+  {
+#ifdef BIGINT_ASM_LIMBS
+    return asm_add_long_mul_long_short(res, a, n, b);
+#else
+    place_t carry = 0;
+    for (size_t i = 0; i < n; i++)
+      res[i] = mul_add_places(a[i], b, res[i], carry, carry);
+    return carry;
+#endif
+  }
+
+  // res[0..n) -= a[0..n) * b, returns high place of the subtrahend plus borrow
+  BIGINT_CONSTEXPR14 place_t submul_1(place_t *res, const place_t *a, size_t n, place_t b)
+  {
+    place_t carry = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+      double_place_t p = double_place_t{a[i]} * b + carry;
+      place_t low = static_cast<place_t>(p), ri = res[i];
+      res[i] = ri - low;
+      carry = static_cast<place_t>(p >> PLACE_BITS) + (ri < low);
+    }
+    return carry;
+  }
+
+  // number of leading zero bits of non-zero x
+  BIGINT_CONSTEXPR14 int leading_zeros(place_t x)
+  {
+    int res = 0;
+    for (place_t mask = place_t{1} << (PLACE_BITS - 1); (x & mask) == 0; mask >>= 1)
+      res++;
+    return res;
+  }
+
+  /***
+   * Division by invariant place (Moller & Granlund), without double-width division:
+   * d is normalized (highest bit set), B = 2^PLACE_BITS
+   ***/
+
+  // floor((B^2 - 1) / d) - B
+  BIGINT_CONSTEXPR14 place_t reciprocal(place_t d)
+  {
+    return static_cast<place_t>(((double_place_t{static_cast<place_t>(~d)} << PLACE_BITS) |
+                                 std::numeric_limits<place_t>::max()) / d);
+  }
+
+  // (u1 * B + u0) / d, u1 < d, v = reciprocal(d): returns quotient, rem = remainder
+  BIGINT_CONSTEXPR14 place_t div_2_1(place_t u1, place_t u0, place_t d, place_t v, place_t &rem)
+  {
+    // product and sum are taken modulo B^2
+    double_place_t q = double_place_t{v} * u1 + ((double_place_t{u1} << PLACE_BITS) | u0);
+    place_t q1 = static_cast<place_t>(q >> PLACE_BITS) + 1, q0 = static_cast<place_t>(q);
+    rem = u0 - q1 * d;
+    if (rem > q0)
+    {
+      q1--;
+      rem += d;
+    }
+    if (rem >= d)
+    {
+      q1++;
+      rem -= d;
+    }
+    return q1;
+  }
+
+  // quotient place estimate from 3 leading places of a remainder n2:n1:n0 and 2 of a divisor d1:d0
+  // (d1 is normalized, v = reciprocal(d1), the remainder is less than the divisor times B):
+  // it is at most 1 greater than the real quotient place
+  BIGINT_CONSTEXPR14 place_t div_3_2_estimate(place_t n2, place_t n1, place_t n0, place_t d1, place_t d0, place_t v)
+  {
+    place_t qt = 0, rt = 0;
+    bool rt_overflow = false;
+    if (n2 == d1)
+    {
+      // estimate does not fit into a place, take the largest one
+      qt = std::numeric_limits<place_t>::max();
+      rt = n1 + d1;
+      rt_overflow = rt < d1;
+    }
+    else
+      qt = div_2_1(n2, n1, d1, v, rt);
+    while (!rt_overflow && double_place_t{qt} * d0 > ((double_place_t{rt} << PLACE_BITS) | n0))
+    {
+      qt--;
+      rt += d1;
+      rt_overflow = rt < d1;
+    }
+    return qt;
+  }
+
+  // q[0..n) = a[0..n) / d, d != 0, returns remainder
+  inline place_t div_1(place_t *q, const place_t *a, size_t n, place_t d)
+  {
+    if (n == 0)
+      return 0;
+    int shift = leading_zeros(d);
+    d <<= shift;
+    place_t v = reciprocal(d), rem = 0;
+    if (shift == 0)
+    {
+      for (size_t i = n; i > 0; i--)
+        q[i - 1] = div_2_1(rem, a[i - 1], d, v, rem);
+      return rem;
+    }
+    // numerator is shifted on the fly, q may coincide with a as a[i - 1] is read before q[i] is written
+    rem = a[n - 1] >> (PLACE_BITS - shift);
+    for (size_t i = n - 1; i > 0; i--)
+      q[i] = div_2_1(rem, (a[i] << shift) | (a[i - 1] >> (PLACE_BITS - shift)), d, v, rem);
+    q[0] = div_2_1(rem, a[0] << shift, d, v, rem);
+    return rem >> shift;
+  }
+
+  // res[0..n) = a[0..n) << bits, 0 < bits < PLACE_BITS, returns shifted out bits
+  // (res may be above a in memory: processed from the top)
+  inline place_t lshift(place_t *res, const place_t *a, size_t n, int bits)
+  {
+    place_t out = a[n - 1] >> (PLACE_BITS - bits);
+    for (size_t i = n - 1; i > 0; i--)
+      res[i] = (a[i] << bits) | (a[i - 1] >> (PLACE_BITS - bits));
+    res[0] = a[0] << bits;
+    return out;
+  }
+
+  // res[0..n) = a[0..n) >> bits, 0 < bits < PLACE_BITS, high bits are filled with 'fill',
+  // returns shifted out bits (in high bits of the result)
+  // (res may be below a in memory: processed from the bottom)
+  inline place_t rshift(place_t *res, const place_t *a, size_t n, int bits, place_t fill = 0)
+  {
+    place_t out = a[0] << (PLACE_BITS - bits);
+    for (size_t i = 0; i + 1 < n; i++)
+      res[i] = (a[i] >> bits) | (a[i + 1] << (PLACE_BITS - bits));
+    res[n - 1] = (a[n - 1] >> bits) | (fill << (PLACE_BITS - bits));
+    return out;
+  }
+
+  // compares a[0..n) and b[0..n)
+  inline int cmp_n(const place_t *a, const place_t *b, size_t n)
+  {
+    for (size_t i = n; i > 0; i--)
+      if (a[i - 1] != b[i - 1])
+        return a[i - 1] > b[i - 1] ? 1 : -1;
+    return 0;
+  }
+
+  // size of a[0..n) without leading zero places
+  inline size_t normalized_size(const place_t *a, size_t n)
+  {
+    while (n > 0 && a[n - 1] == 0)
+      n--;
+    return n;
+  }
+
+  // res[0..n) = |a[0..n) - b[0..n)|, returns true if a < b
+  inline bool sub_abs_n(place_t *res, const place_t *a, const place_t *b, size_t n)
+  {
+    if (cmp_n(a, b, n) < 0)
+    {
+      sub_n(res, b, a, n);
+      return true;
+    }
+    sub_n(res, a, b, n);
+    return false;
+  }
+
+  // res[0..n) = a[0..n) / 3, division must be exact modulo 2^(n * PLACE_BITS)
+  // (so two's complement negative numbers are handled as well)
+  inline void divexact_by3(place_t *res, const place_t *a, size_t n)
+  {
+    // inverse of 3 modulo 2^PLACE_BITS
+    static constexpr place_t inverse = std::numeric_limits<place_t>::max() / 3 * 2 + 1;
+    place_t borrow = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+      place_t ai = a[i], s = ai - borrow;
+      borrow = ai < borrow;
+      place_t q = s * inverse;
+      res[i] = q;
+      borrow += static_cast<place_t>((double_place_t{q} * 3) >> PLACE_BITS);
+    }
+  }
+
+  /***
+   * Hashing: xxHash64-style rounds over 64-bit words in four independent lanes
+   * (so that they are pipelined), lanes are then mixed with the length and avalanched.
+   ***/
+  inline uint64_t hash_rotl(uint64_t x, int r)
+  {
+    return x << r | x >> (64 - r);
+  }
+
+  inline uint64_t hash_round(uint64_t acc, uint64_t word)
+  {
+    return hash_rotl(acc + word * 0xC2B2AE3D27D4EB4Full, 31) * 0x9E3779B185EBCA87ull;
+  }
+
+  // hash of a[0..n)
+  inline uint64_t hash_n(const place_t *a, size_t n)
+  {
+    constexpr size_t WORD_PLACES = 64 / PLACE_BITS;
+    auto word = [a](size_t i)
+    {
+      uint64_t w = 0;
+      for (size_t j = 0; j < WORD_PLACES; j++)
+        w |= static_cast<uint64_t>(a[i * WORD_PLACES + j]) << (j * PLACE_BITS);
+      return w;
+    };
+
+    size_t words = n / WORD_PLACES, i = 0;
+    uint64_t lanes[4] = {0x60EA27EEADC0B5D6ull, 0xC2B2AE3D27D4EB4Full, 0, 0x61C8864E7A143579ull};
+    for (; i + 4 <= words; i += 4)
+      for (size_t l = 0; l < 4; l++)
+        lanes[l] = hash_round(lanes[l], word(i + l));
+    uint64_t h = hash_rotl(lanes[0], 1) + hash_rotl(lanes[1], 7) + hash_rotl(lanes[2], 12) + hash_rotl(lanes[3], 18) + n;
+    for (; i < words; i++)
+      h = hash_round(h, word(i));
+    // the last place of an odd number of half-word places
+    if (words * WORD_PLACES < n)
+      h = hash_round(h, a[n - 1]);
+
+    h ^= h >> 33;
+    h *= 0xC2B2AE3D27D4EB4Full;
+    h ^= h >> 29;
+    h *= 0x165667B19E3779F9ull;
+    return h ^ h >> 32;
+  }
+} // end of 'big_int_util' namespace
+
+#endif // LIMB_ARITHMETIC_H
@@ -0,0 +1,212 @@
+/* Nikolai Kholiavin, M3138 */
+
+#include "modular.h"
+#include "multiplication.h"
+#include "division.h"
+
+namespace big_int_util
+{
+  /* Montgomery context */
+  montgomery_context::montgomery_context(const place_t *m, size_t n)
+    : m(m, m + n), r2(n), prod(2 * n), scratch(mul_scratch_size(n))
+  {
+    // Newton's iteration for the inverse modulo B, m[0] * m[0] = 1 mod 8 for odd m[0],
+    // every step doubles the number of correct low bits
+    place_t inv = m[0];
+    for (int bits = 3; bits < PLACE_BITS; bits *= 2)
+      inv *= 2 - m[0] * inv;
+    m_inv = -inv;
+
+    // r2 = B^2n mod m
+    std::vector<place_t> num(2 * n + 1, 0), q(n + 2);
+    num[2 * n] = 1;
+    div_qr(q.data(), r2.data(), num.data(), 2 * n + 1, m, n);
+  }
+
+  void montgomery_context::reduce(place_t *res)
+  {
+    size_t n = size();
+    // adding multiples of m zeroes low places one by one, 'top' is the carry above prod[i + n]
+    place_t top = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+      place_t carry = addmul_1(prod.data() + i, m.data(), n, prod[i] * m_inv);
+      place_t s = prod[i + n] + top;
+      top = s < top;
+      prod[i + n] = s + carry;
+      top += prod[i + n] < carry;
+    }
+    // the result is less than 2m
+    if (top != 0 || cmp_n(prod.data() + n, m.data(), n) >= 0)
+      sub_n(res, prod.data() + n, m.data(), n);
+    else
+      std::copy_n(prod.data() + n, n, res);
+  }
+
+  void montgomery_context::to_form(place_t *res, const place_t *a)
+  {
+    mul(res, a, r2.data());
+  }
+
+  void montgomery_context::from_form(place_t *res, const place_t *a)
+  {
+    size_t n = size();
+    std::copy_n(a, n, prod.data());
+    std::fill_n(prod.data() + n, n, 0);
+    reduce(res);
+  }
+
+  void montgomery_context::mul(place_t *res, const place_t *a, const place_t *b)
+  {
+    size_t n = size();
+    big_int_util::mul(prod.data(), a, n, b, n, scratch.data());
+    reduce(res);
+  }
+
+  void montgomery_context::sqr(place_t *res, const place_t *a)
+  {
+    big_int_util::sqr(prod.data(), a, size(), scratch.data());
+    reduce(res);
+  }
+
+  /* Barrett context */
+  barrett_context::barrett_context(const place_t *m, size_t n) : m(m, m + n), prod(2 * n)
+  {
+    // mu = floor(B^2n / m) has n + 1 places (n + 2 if m = B^(n - 1))
+    std::vector<place_t> num(2 * n + 1, 0), r(n);
+    num[2 * n] = 1;
+    mu.resize(n + 2);
+    div_qr(mu.data(), r.data(), num.data(), 2 * n + 1, m, n);
+    mu.resize(normalized_size(mu.data(), n + 2));
+    // q1 * mu and q3 * m
+    q.resize(n + 1 + mu.size() + 2 * n);
+    scratch.resize(mul_scratch_size(std::max(n + 1, mu.size())));
+  }
+
+  void barrett_context::to_form(place_t *res, const place_t *a)
+  {
+    std::copy_n(a, size(), res);
+  }
+
+  void barrett_context::from_form(place_t *res, const place_t *a)
+  {
+    std::copy_n(a, size(), res);
+  }
+
+  void barrett_context::mul(place_t *res, const place_t *a, const place_t *b)
+  {
+    big_int_util::mul(prod.data(), a, size(), b, size(), scratch.data());
+    reduce(res);
+  }
+
+  void barrett_context::sqr(place_t *res, const place_t *a)
+  {
+    big_int_util::sqr(prod.data(), a, size(), scratch.data());
+    reduce(res);
+  }
+
+  void barrett_context::reduce(place_t *res)
+  {
+    size_t n = size();
+    place_t *x = prod.data(), *q2 = q.data(), *r2 = q2 + n + 1 + mu.size();
+
+    // q3 = floor(floor(x / B^(n - 1)) * mu / B^(n + 1)) is at most 2 less than x / m < B^n
+    big_int_util::mul(q2, x + n - 1, n + 1, mu.data(), mu.size(), scratch.data());
+    const place_t *q3 = q2 + n + 1;
+    // r = x - q3 * m modulo B^(n + 1), it is the real remainder plus at most 2m
+    big_int_util::mul(r2, q3, n, m.data(), n, scratch.data());
+    sub_n(x, x, r2, n + 1);
+    while (x[n] != 0 || cmp_n(x, m.data(), n) >= 0)
+      x[n] -= sub_n(x, x, m.data(), n);
+    std::copy_n(x, n, res);
+  }
+
+  namespace
+  {
+    // sliding window size for exponent of 'bits' bits (minimizes multiplications)
+    int window_size(size_t bits)
+    {
+      static constexpr size_t limits[] = {8, 24, 80, 240, 672};
+      int k = 1;
+      for (size_t limit : limits)
+        if (bits > limit)
+          k++;
+      return k;
+    }
+
+    // res[0..n) = a[0..n)^e[0..en) in the context form, e[en - 1] != 0
+    template<typename context>
+      void pow_window(context &ctx, place_t *res, const place_t *a, const place_t *e, size_t en)
+    {
+      size_t n = ctx.size(), bits = en * PLACE_BITS - leading_zeros(e[en - 1]);
+      int k = window_size(bits);
+      auto bit = [e](size_t i) { return (e[i / PLACE_BITS] >> (i % PLACE_BITS)) & 1; };
+
+      // odd powers a, a^3, ..., a^(2^k - 1)
+      std::vector<place_t> table(n << (k - 1)), square(n);
+      ctx.to_form(table.data(), a);
+      if (k > 1)
+      {
+        ctx.sqr(square.data(), table.data());
+        for (size_t i = 1; i < size_t{1} << (k - 1); i++)
+          ctx.mul(table.data() + i * n, table.data() + (i - 1) * n, square.data());
+      }
+
+      // left to right: window of at most k bits ending with 1 where the exponent has 1
+      bool started = false;
+      for (size_t i = bits; i > 0;)
+      {
+        if (!bit(i - 1))
+        {
+          ctx.sqr(res, res);
+          i--;
+          continue;
+        }
+        size_t j = i >= static_cast<size_t>(k) ? i - k : 0;
+        while (!bit(j))
+          j++;
+        size_t window = 0;
+        for (size_t l = i; l > j; l--)
+          window = window << 1 | bit(l - 1);
+        const place_t *power = table.data() + (window >> 1) * n;
+        if (started)
+        {
+          for (size_t l = j; l < i; l++)
+            ctx.sqr(res, res);
+          ctx.mul(res, res, power);
+        }
+        else
+        {
+          std::copy_n(power, n, res);
+          started = true;
+        }
+        i = j;
+      }
+      ctx.from_form(res, res);
+    }
+
+    template<typename context>
+      void pow_with(context &&ctx, place_t *res, const place_t *a, size_t an, const place_t *e, size_t en)
+    {
+      std::vector<place_t> base(ctx.size(), 0);
+      std::copy_n(a, an, base.data());
+      pow_window(ctx, res, base.data(), e, en);
+    }
+  }
+
+  void pow_mod(place_t *res, const place_t *a, size_t an, const place_t *e, size_t en, const place_t *m, size_t mn)
+  {
+    en = normalized_size(e, en);
+    if (en == 0)
+    {
+      // x^0 = 1 modulo anything but 1
+      std::fill_n(res, mn, 0);
+      res[0] = mn > 1 || m[0] != 1;
+      return;
+    }
+    if (m[0] & 1)
+      pow_with(montgomery_context(m, mn), res, a, an, e, en);
+    else
+      pow_with(barrett_context(m, mn), res, a, an, e, en);
+  }
+} // end of 'big_int_util' namespace
@@ -0,0 +1,67 @@
+/* Nikolai Kholiavin, M3138 */
+
+#ifndef MODULAR_H
+#define MODULAR_H
+
+#include <vector>
+
+#include "limb_arithmetic.h"
+
+namespace big_int_util
+{
+  /***
+   * Modular multiplication contexts: precomputed values and scratch places for a fixed
+   * modulus m[0..n), m[n - 1] != 0. Residues are n-place values less than m kept in the
+   * context's own form (to_form/from_form), mul and sqr may have the result coincide with an operand.
+   ***/
+
+  /* Montgomery multiplication (odd modulus), residue x is kept as x * B^n mod m */
+  class montgomery_context
+  {
+  private:
+    std::vector<place_t> m, r2, prod, scratch;
+    // -m^-1 mod B
+    place_t m_inv;
+
+    // res[0..n) = prod[0..2n) / B^n mod m, prod < m * B^n
+    void reduce(place_t *res);
+
+  public:
+    montgomery_context(const place_t *m, size_t n);
+
+    size_t size() const { return m.size(); }
+
+    void to_form(place_t *res, const place_t *a);
+    void from_form(place_t *res, const place_t *a);
+    void mul(place_t *res, const place_t *a, const place_t *b);
+    void sqr(place_t *res, const place_t *a);
+  };
+
+  /* Barrett reduction (any modulus), residues are kept as they are */
+  class barrett_context
+  {
+  private:
+    // mu = floor(B^2n / m)
+    std::vector<place_t> m, mu, prod, q, scratch;
+
+    // res[0..n) = prod[0..2n) mod m
+    void reduce(place_t *res);
+
+  public:
+    barrett_context(const place_t *m, size_t n);
+
+    size_t size() const { return m.size(); }
+
+    void to_form(place_t *res, const place_t *a);
+    void from_form(place_t *res, const place_t *a);
+    void mul(place_t *res, const place_t *a, const place_t *b);
+    void sqr(place_t *res, const place_t *a);
+  };
+
+  // res[0..mn) = a[0..an)^e[0..en) mod m[0..mn), a < m (so an <= mn), mn > 0, m[mn - 1] != 0,
+  // operands may have leading zero places (en == 0 is the zero exponent),
+  // Montgomery multiplication is used for odd modulus, Barrett reduction otherwise
+  void pow_mod(place_t *res, const place_t *a, size_t an, const place_t *e, size_t en, const place_t *m, size_t mn);
+} // end of 'big_int_util' namespace
+
+#endif // MODULAR_H
@@ -0,0 +1,365 @@
+/* Nikolai Kholiavin, M3138 */
+
+#include <vector>
+
+#include "multiplication.h"
+#include "ntt.h"
+#include "parallel.h"
+
+namespace big_int_util
+{
+  size_t mul_thresholds::karatsuba = 32;
+  size_t mul_thresholds::toom3 = 200;
+  // transforms work on 32-bit digits, so wider places reach the crossover later
+  size_t mul_thresholds::ntt = PLACE_BITS == 64 ? 16000 : 7000;
+
+  namespace
+  {
+    // thresholds used by dispatching, clamped so that recursion always terminates
+    size_t karatsuba_threshold() { return std::max(mul_thresholds::karatsuba, size_t{2}); }
+    size_t toom3_threshold() { return std::max(mul_thresholds::toom3, size_t{3}); }
+
+    // number of scratch places enough for multiplication of operands with at most n places
+    size_t scratch_size(size_t n)
+    {
+      size_t res = 0;
+      while (n >= karatsuba_threshold())
+      {
+        size_t k = (n + 1) / 2, own = 6 * k + 1, next = k;
+        if (n >= toom3_threshold())
+        {
+          size_t t = (n + 2) / 3 + 1;
+          own = std::max(own, 13 * t);
+          next = std::max(next, t);
+        }
+        res += own;
+        n = next;
+      }
+      return res;
+    }
+
+    void mul_rec(place_t *res, const place_t *a, size_t an, const place_t *b, size_t bn, place_t *scratch);
+    void sqr_trimmed(place_t *res, const place_t *a, size_t n, place_t *scratch);
+
+    // res[0..an + bn) = a[0..an) * b[0..bn), operands may have leading zero places
+    void mul_trimmed(place_t *res, const place_t *a, size_t an, const place_t *b, size_t bn, place_t *scratch)
+    {
+      size_t na = normalized_size(a, an), nb = normalized_size(b, bn);
+      if (na == 0 || nb == 0)
+      {
+        std::fill_n(res, an + bn, 0);
+        return;
+      }
+      mul_rec(res, a, na, b, nb, scratch);
+      std::fill(res + na + nb, res + an + bn, 0);
+    }
+
+    // one of independent products of a recursion step, b == nullptr -- square of a
+    struct product
+    {
+      place_t *res;
+      const place_t *a;
+      size_t an;
+      const place_t *b;
+      size_t bn;
+    };
+
+    // products one after another in the same scratch or, for operands of 'size' places
+    // large enough, in parallel with scratch of their own
+    void mul_group(const product *products, size_t count, size_t size, place_t *scratch)
+    {
+      auto compute = [](const product &p, place_t *s)
+      {
+        if (p.b == nullptr)
+          sqr_trimmed(p.res, p.a, p.an, s);
+        else
+          mul_trimmed(p.res, p.a, p.an, p.b, p.bn, s);
+      };
+      if (!parallel_worth(size, parallel_thresholds::mul))
+      {
+        for (size_t i = 0; i < count; i++)
+          compute(products[i], scratch);
+        return;
+      }
+
+      task_group group;
+      for (size_t i = 1; i < count; i++)
+      {
+        const product &p = products[i];
+        group.run([&compute, &p]
+          {
+            std::vector<place_t> own(scratch_size(std::max(p.an, p.bn)));
+            compute(p, own.data());
+          });
+      }
+      compute(products[0], scratch);
+      group.wait();
+    }
+
+    // adds a[0..n) to res[0..rn), higher places of a (must be zero) are ignored
+    void add_into(place_t *res, size_t rn, const place_t *a, size_t n)
+    {
+      add(res, res, rn, a, std::min(n, rn));
+    }
+
+    void schoolbook(place_t *res, const place_t *a, size_t an, const place_t *b, size_t bn)
+    {
+      res[an] = mul_1(res, a, an, b[0]);
+      for (size_t j = 1; j < bn; j++)
+        res[an + j] = addmul_1(res + j, a, an, b[j]);
+    }
+
+    // an >= 2 * bn - 1: a is split into bn-sized chunks
+    void unbalanced(place_t *res, const place_t *a, size_t an, const place_t *b, size_t bn, place_t *scratch)
+    {
+      place_t *tmp = scratch;
+      scratch += 2 * bn;
+
+      mul_trimmed(res, a, bn, b, bn, scratch);
+      for (size_t off = bn; off < an; off += bn)
+      {
+        size_t len = std::min(bn, an - off);
+        mul_trimmed(tmp, a + off, len, b, bn, scratch);
+        std::copy_n(tmp + bn, len, res + off + bn);
+        add(res + off, res + off, bn + len, tmp, bn);
+      }
+    }
+
+    // a = a1 * B^k + a0, b = b1 * B^k + b0, k = ceil(an / 2) < bn <= an
+    // a * b = z2 * B^2k + (z0 + z2 - (a0 - a1)(b0 - b1)) * B^k + z0
+    void karatsuba(place_t *res, const place_t *a, size_t an, const place_t *b, size_t bn, place_t *scratch)
+    {
+      size_t k = (an + 1) / 2, a1n = an - k, b1n = bn - k;
+      place_t *da = scratch, *db = da + k, *prod = db + k, *mid = prod + 2 * k;
+      scratch = mid + 2 * k + 1;
+
+      // |a0 - a1|, |b0 - b1|
+      std::copy_n(a + k, a1n, da);
+      std::fill(da + a1n, da + k, 0);
+      bool a_neg = sub_abs_n(da, a, da, k);
+      std::copy_n(b + k, b1n, db);
+      std::fill(db + b1n, db + k, 0);
+      bool b_neg = sub_abs_n(db, b, db, k);
+
+      const product products[] = {{res, a, k, b, k}, {res + 2 * k, a + k, a1n, b + k, b1n}, {prod, da, k, db, k}};
+      mul_group(products, 3, bn, scratch);
+
+      std::copy_n(res, 2 * k, mid);
+      mid[2 * k] = add(mid, mid, 2 * k, res + 2 * k, a1n + b1n);
+      if (a_neg == b_neg)
+        sub(mid, mid, 2 * k + 1, prod, 2 * k);
+      else
+        add(mid, mid, 2 * k + 1, prod, 2 * k);
+      add_into(res + k, an + bn - k, mid, 2 * k + 1);
+    }
+
+    // x(1) = x0 + x1 + x2 into k + 1 places
+    void toom3_eval_1(place_t *dst, const place_t *x, size_t k, size_t x2n)
+    {
+      dst[k] = add_n(dst, x, x + k, k);
+      dst[k] += add(dst, dst, k, x + 2 * k, x2n);
+    }
+
+    // |x(-1)| = |x0 - x1 + x2| into k + 1 places, returns sign
+    bool toom3_eval_m1(place_t *dst, const place_t *x, size_t k, size_t x2n, place_t *tmp)
+    {
+      tmp[k] = add(tmp, x, k, x + 2 * k, x2n);
+      if (tmp[k] == 0 && cmp_n(tmp, x + k, k) < 0)
+      {
+        sub_n(dst, x + k, tmp, k);
+        dst[k] = 0;
+        return true;
+      }
+      dst[k] = tmp[k] - sub_n(dst, tmp, x + k, k);
+      return false;
+    }
+
+    // |x(-2)| = |x0 - 2 * x1 + 4 * x2| into k + 1 places, returns sign
+    bool toom3_eval_m2(place_t *dst, const place_t *x, size_t k, size_t x2n, place_t *tmp)
+    {
+      std::copy_n(x + 2 * k, x2n, tmp);
+      std::fill(tmp + x2n, tmp + k + 1, 0);
+      tmp[x2n] = lshift(tmp, tmp, x2n, 2);
+      add(tmp, tmp, k + 1, x, k);
+      dst[k] = lshift(dst, x + k, k, 1);
+      return sub_abs_n(dst, tmp, dst, k + 1);
+    }
+
+    // arithmetic shift right by 1 of n-place two's complement number
+    void halve(place_t *x, size_t n)
+    {
+      rshift(x, x, n, 1, x[n - 1] >> (PLACE_BITS - 1));
+    }
+
+    // Toom-3 with evaluation points 0, 1, -1, -2, inf and Bodrato's interpolation sequence,
+    // a = a2 * B^2k + a1 * B^k + a0, the same for b, k = ceil(an / 3), 2k < bn <= an
+    void toom3(place_t *res, const place_t *a, size_t an, const place_t *b, size_t bn, place_t *scratch)
+    {
+      size_t k = (an + 2) / 3, k1 = k + 1, w = 2 * k1;
+      size_t a2n = an - 2 * k, b2n = bn - 2 * k, vinfn = a2n + b2n;
+      // point values at 1, -1, -2 are kept as w-place two's complement numbers,
+      // operands are evaluated at all points first, so that the five products are independent
+      place_t *pa1 = scratch, *pb1 = pa1 + k1, *pam1 = pb1 + k1, *pbm1 = pam1 + k1,
+        *pam2 = pbm1 + k1, *pbm2 = pam2 + k1, *tmp = pbm2 + k1,
+        *v1 = tmp + k1, *vm1 = v1 + w, *vm2 = vm1 + w;
+      scratch = vm2 + w;
+
+      toom3_eval_1(pa1, a, k, a2n);
+      toom3_eval_1(pb1, b, k, b2n);
+      bool neg_m1 = toom3_eval_m1(pam1, a, k, a2n, tmp) ^ toom3_eval_m1(pbm1, b, k, b2n, tmp);
+      bool neg_m2 = toom3_eval_m2(pam2, a, k, a2n, tmp) ^ toom3_eval_m2(pbm2, b, k, b2n, tmp);
+
+      // values at 0 and inf go directly to the result
+      const place_t *v0 = res, *vinf = res + 4 * k;
+      const product products[] = {{res, a, k, b, k}, {res + 4 * k, a + 2 * k, a2n, b + 2 * k, b2n},
+                                  {v1, pa1, k1, pb1, k1}, {vm1, pam1, k1, pbm1, k1}, {vm2, pam2, k1, pbm2, k1}};
+      mul_group(products, 5, bn, scratch);
+      if (neg_m1)
+        neg_n(vm1, vm1, w);
+      if (neg_m2)
+        neg_n(vm2, vm2, w);
+
+      // r3 = (v(-2) - v(1)) / 3
+      sub_n(vm2, vm2, v1, w);
+      divexact_by3(vm2, vm2, w);
+      // r1 = (v(1) - v(-1)) / 2
+      sub_n(v1, v1, vm1, w);
+      halve(v1, w);
+      // r2 = v(-1) - v(0)
+      sub(vm1, vm1, w, v0, 2 * k);
+      // r3 = (r2 - r3) / 2 + 2 * v(inf)
+      sub_n(vm2, vm1, vm2, w);
+      halve(vm2, w);
+      add(vm2, vm2, w, vinf, vinfn);
+      add(vm2, vm2, w, vinf, vinfn);
+      // r2 = r2 + r1 - v(inf)
+      add_n(vm1, vm1, v1, w);
+      sub(vm1, vm1, w, vinf, vinfn);
+      // r1 = r1 - r3
+      sub_n(v1, v1, vm2, w);
+
+      // res = v(inf) * B^4k + r3 * B^3k + r2 * B^2k + r1 * B^k + v(0)
+      size_t n = an + bn;
+      std::fill(res + 2 * k, res + 4 * k, 0);
+      add_into(res + k, n - k, v1, w);
+      add_into(res + 2 * k, n - 2 * k, vm1, w);
+      add_into(res + 3 * k, n - 3 * k, vm2, w);
+    }
+
+    // res[0..2n) = a[0..n)^2: products of different places are summed once and doubled
+    void schoolbook_sqr(place_t *res, const place_t *a, size_t n)
+    {
+      res[0] = 0;
+      res[n] = mul_1(res + 1, a + 1, n - 1, a[0]);
+      for (size_t i = 1; i < n; i++)
+        res[n + i] = addmul_1(res + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+      // the doubled sum is less than B^2n
+      lshift(res, res, 2 * n, 1);
+      place_t carry = 0;
+      for (size_t i = 0; i < n; i++)
+      {
+        double_place_t sq = double_place_t{a[i]} * a[i];
+        double_place_t s = double_place_t{res[2 * i]} + static_cast<place_t>(sq) + carry;
+        res[2 * i] = static_cast<place_t>(s);
+        s = double_place_t{res[2 * i + 1]} + static_cast<place_t>(sq >> PLACE_BITS) + static_cast<place_t>(s >> PLACE_BITS);
+        res[2 * i + 1] = static_cast<place_t>(s);
+        carry = static_cast<place_t>(s >> PLACE_BITS);
+      }
+    }
+
+    void sqr_rec(place_t *res, const place_t *a, size_t n, place_t *scratch);
+
+    // res[0..2n) = a[0..n)^2, a may have leading zero places
+    void sqr_trimmed(place_t *res, const place_t *a, size_t n, place_t *scratch)
+    {
+      size_t na = normalized_size(a, n);
+      if (na == 0)
+      {
+        std::fill_n(res, 2 * n, 0);
+        return;
+      }
+      sqr_rec(res, a, na, scratch);
+      std::fill(res + 2 * na, res + 2 * n, 0);
+    }
+
+    // a = a1 * B^k + a0, k = ceil(n / 2): a^2 = z2 * B^2k + (z0 + z2 - (a0 - a1)^2) * B^k + z0
+    void karatsuba_sqr(place_t *res, const place_t *a, size_t n, place_t *scratch)
+    {
+      size_t k = (n + 1) / 2, a1n = n - k;
+      place_t *da = scratch, *prod = da + k, *mid = prod + 2 * k;
+      scratch = mid + 2 * k + 1;
+
+      std::copy_n(a + k, a1n, da);
+      std::fill(da + a1n, da + k, 0);
+      sub_abs_n(da, a, da, k);
+
+      const product products[] = {{res, a, k, nullptr, 0}, {res + 2 * k, a + k, a1n, nullptr, 0}, {prod, da, k, nullptr, 0}};
+      mul_group(products, 3, n, scratch);
+
+      std::copy_n(res, 2 * k, mid);
+      mid[2 * k] = add(mid, mid, 2 * k, res + 2 * k, 2 * a1n);
+      sub(mid, mid, 2 * k + 1, prod, 2 * k);
+      add_into(res + k, 2 * n - k, mid, 2 * k + 1);
+    }
+
+    // n > 0, dispatches by operand size (Toom-3 and NTT are shared with multiplication)
+    void sqr_rec(place_t *res, const place_t *a, size_t n, place_t *scratch)
+    {
+      if (n >= mul_thresholds::ntt && ntt_fits(n, n))
+        ntt_mul(res, a, n, a, n);
+      else if (n < karatsuba_threshold())
+        schoolbook_sqr(res, a, n);
+      else if (n >= toom3_threshold())
+        toom3(res, a, n, a, n, scratch);
+      else
+        karatsuba_sqr(res, a, n, scratch);
+    }
+
+    // an, bn > 0, dispatches by operand sizes
+    void mul_rec(place_t *res, const place_t *a, size_t an, const place_t *b, size_t bn, place_t *scratch)
+    {
+      if (an < bn)
+      {
+        std::swap(a, b);
+        std::swap(an, bn);
+      }
+      if (bn >= mul_thresholds::ntt && ntt_fits(an, bn))
+        ntt_mul(res, a, an, b, bn);
+      else if (bn < karatsuba_threshold())
+        schoolbook(res, a, an, b, bn);
+      else if (bn <= (an + 1) / 2)
+        unbalanced(res, a, an, b, bn, scratch);
+      else if (bn >= toom3_threshold() && bn > 2 * ((an + 2) / 3))
+        toom3(res, a, an, b, bn, scratch);
+      else
+        karatsuba(res, a, an, b, bn, scratch);
+    }
+  }
+
+  void mul(place_t *res, const place_t *a, size_t an, const place_t *b, size_t bn)
+  {
+    std::vector<place_t> scratch(scratch_size(std::max(an, bn)));
+    mul_trimmed(res, a, an, b, bn, scratch.data());
+  }
+
+  void sqr(place_t *res, const place_t *a, size_t n)
+  {
+    std::vector<place_t> scratch(scratch_size(n));
+    sqr_trimmed(res, a, n, scratch.data());
+  }
+
+  size_t mul_scratch_size(size_t n)
+  {
+    return scratch_size(n);
+  }
+
+  void mul(place_t *res, const place_t *a, size_t an, const place_t *b, size_t bn, place_t *scratch)
+  {
+    mul_trimmed(res, a, an, b, bn, scratch);
+  }
+
+  void sqr(place_t *res, const place_t *a, size_t n, place_t *scratch)
+  {
+    sqr_trimmed(res, a, n, scratch);
+  }
+} // end of 'big_int_util' namespace
@@ -0,0 +1,37 @@
+/* Nikolai Kholiavin, M3138 */
+
+#ifndef MULTIPLICATION_H
+#define MULTIPLICATION_H
+
+#include "limb_arithmetic.h"
+
+namespace big_int_util
+{
+  /* Multiplication algorithm thresholds (in places of the smaller operand), tunable */
+  struct mul_thresholds
+  {
+    // schoolbook below, Karatsuba from this size on
+    static size_t karatsuba;
+    // Toom-3 from this size on (for operands balanced enough)
+    static size_t toom3;
+    // number-theoretic transform from this size on (if operands are not too large for it)
+    static size_t ntt;
+  };
+
+  // res[0..an + bn) = a[0..an) * b[0..bn), an, bn > 0,
+  // res must not overlap with operands
+  void mul(place_t *res, const place_t *a, size_t an, const place_t *b, size_t bn);
+
+  // res[0..2n) = a[0..n)^2, n > 0, res must not overlap with a
+  void sqr(place_t *res, const place_t *a, size_t n);
+
+  // number of scratch places for mul and sqr below with operands of at most n places
+  // (for the current thresholds)
+  size_t mul_scratch_size(size_t n);
+
+  // mul and sqr in caller's scratch of mul_scratch_size places, for repeated products of the same size
+  void mul(place_t *res, const place_t *a, size_t an, const place_t *b, size_t bn, place_t *scratch);
+  void sqr(place_t *res, const place_t *a, size_t n, place_t *scratch);
+} // end of 'big_int_util' namespace
+
+#endif // MULTIPLICATION_H
@@ -0,0 +1,269 @@
+/* Nikolai Kholiavin, M3138 */
+
+#include <vector>
+
+#include "ntt.h"
+#include "parallel.h"
+
+namespace big_int_util
+{
+  namespace
+  {
+    // NTT-friendly primes c * 2^k + 1 (all with primitive root 3), product exceeds 2^86
+    constexpr uint32_t PRIMES[] = {998244353, 167772161, 469762049};
+    constexpr uint32_t PRIMITIVE_ROOT = 3;
+    // 2^23 divides p - 1 for all primes
+    constexpr size_t MAX_LENGTH = size_t{1} << 23;
+
+    // transforms work on 32-bit digits, so that coefficients of a product of
+    // 2^22 digits are below the product of primes
+    constexpr int DIGIT_BITS = 32;
+    constexpr size_t DIGITS_PER_PLACE = PLACE_BITS / DIGIT_BITS;
+
+    uint32_t get_digit(const place_t *a, size_t i)
+    {
+      return static_cast<uint32_t>(a[i / DIGITS_PER_PLACE] >> (DIGIT_BITS * (i % DIGITS_PER_PLACE)));
+    }
+
+    void set_digit(place_t *a, size_t i, uint32_t digit)
+    {
+      if (i % DIGITS_PER_PLACE == 0)
+        a[i / DIGITS_PER_PLACE] = digit;
+      else
+        a[i / DIGITS_PER_PLACE] |= place_t{digit} << (DIGIT_BITS * (i % DIGITS_PER_PLACE));
+    }
+
+    uint32_t pow_mod(uint32_t base, uint32_t exp, uint32_t mod)
+    {
+      uint64_t res = 1, b = base;
+      for (; exp != 0; exp >>= 1, b = b * b % mod)
+        if (exp & 1)
+          res = res * b % mod;
+      return static_cast<uint32_t>(res);
+    }
+
+    uint32_t inverse(uint32_t x, uint32_t mod)
+    {
+      return pow_mod(x % mod, mod - 2, mod);
+    }
+
+    // arithmetic modulo prime p < 2^30 with Montgomery multiplication (R = 2^32)
+    struct montgomery_field
+    {
+      uint32_t p, p_neg_inv, r2;
+
+      explicit montgomery_field(uint32_t p) : p(p)
+      {
+        // Newton iteration for p^-1 modulo 2^32, each step doubles correct bits
+        uint32_t inv = p;
+        for (int i = 0; i < 4; i++)
+          inv *= 2 - p * inv;
+        p_neg_inv = -inv;
+        uint64_t r = (uint64_t{1} << 32) % p;
+        r2 = static_cast<uint32_t>(r * r % p);
+      }
+
+      // x * R^-1 mod p, x < p * R
+      uint32_t reduce(uint64_t x) const
+      {
+        uint32_t m = static_cast<uint32_t>(x) * p_neg_inv;
+        uint32_t t = static_cast<uint32_t>((x + uint64_t{m} * p) >> 32);
+        return t >= p ? t - p : t;
+      }
+
+      uint32_t mul(uint32_t a, uint32_t b) const { return reduce(uint64_t{a} * b); }
+      uint32_t to_montgomery(uint32_t a) const { return mul(a, r2); }
+
+      uint32_t add(uint32_t a, uint32_t b) const
+      {
+        uint32_t s = a + b;
+        return s >= p ? s - p : s;
+      }
+
+      uint32_t sub(uint32_t a, uint32_t b) const
+      {
+        return a >= b ? a - b : a + p - b;
+      }
+    };
+
+    // roots[len + j] = w^j (Montgomery form), w -- primitive (2 * len)-th root,
+    // for len = 1, 2, 4 .. n / 2, so that multiplication by roots keeps values in normal form
+    std::vector<uint32_t> compute_roots(const montgomery_field &f, size_t n, bool inverse_roots)
+    {
+      std::vector<uint32_t> roots(n);
+      for (size_t len = 1; len < n; len *= 2)
+      {
+        uint32_t w = pow_mod(PRIMITIVE_ROOT, static_cast<uint32_t>((f.p - 1) / (2 * len)), f.p);
+        if (inverse_roots)
+          w = inverse(w, f.p);
+        uint32_t wm = f.to_montgomery(w), cur = f.to_montgomery(1);
+        for (size_t j = 0; j < len; j++)
+        {
+          roots[len + j] = cur;
+          cur = f.mul(cur, wm);
+        }
+      }
+      return roots;
+    }
+
+    // decimation in frequency: natural order in, bit-reversed order out,
+    // halves are independent after the first stage, so large transforms are split between threads
+    void forward_transform(const montgomery_field &f, uint32_t *a, size_t n, const uint32_t *roots)
+    {
+      if (n >= 2 && parallel_worth(n, parallel_thresholds::ntt))
+      {
+        size_t half = n / 2;
+        parallel_for(half, parallel_thresholds::ntt / 2, [&](size_t begin, size_t end)
+          {
+            for (size_t j = begin; j < end; j++)
+            {
+              uint32_t u = a[j], v = a[j + half];
+              a[j] = f.add(u, v);
+              a[j + half] = f.mul(f.sub(u, v), roots[half + j]);
+            }
+          });
+        task_group group;
+        group.run([&] { forward_transform(f, a, half, roots); });
+        forward_transform(f, a + half, half, roots);
+        group.wait();
+        return;
+      }
+
+      for (size_t len = n / 2; len >= 1; len /= 2)
+        for (size_t i = 0; i < n; i += 2 * len)
+          for (size_t j = 0; j < len; j++)
+          {
+            uint32_t u = a[i + j], v = a[i + j + len];
+            a[i + j] = f.add(u, v);
+            a[i + j + len] = f.mul(f.sub(u, v), roots[len + j]);
+          }
+    }
+
+    // decimation in time: bit-reversed order in, natural order out (not scaled),
+    // halves are independent before the last stage
+    void inverse_transform(const montgomery_field &f, uint32_t *a, size_t n, const uint32_t *roots)
+    {
+      if (n >= 2 && parallel_worth(n, parallel_thresholds::ntt))
+      {
+        size_t half = n / 2;
+        {
+          task_group group;
+          group.run([&] { inverse_transform(f, a, half, roots); });
+          inverse_transform(f, a + half, half, roots);
+          group.wait();
+        }
+        parallel_for(half, parallel_thresholds::ntt / 2, [&](size_t begin, size_t end)
+          {
+            for (size_t j = begin; j < end; j++)
+            {
+              uint32_t u = a[j], v = f.mul(a[j + half], roots[half + j]);
+              a[j] = f.add(u, v);
+              a[j + half] = f.sub(u, v);
+            }
+          });
+        return;
+      }
+
+      for (size_t len = 1; len < n; len *= 2)
+        for (size_t i = 0; i < n; i += 2 * len)
+          for (size_t j = 0; j < len; j++)
+          {
+            uint32_t u = a[i + j], v = f.mul(a[i + j + len], roots[len + j]);
+            a[i + j] = f.add(u, v);
+            a[i + j + len] = f.sub(u, v);
+          }
+    }
+
+    void load_digits(const montgomery_field &f, uint32_t *dst, size_t n, const place_t *a, size_t digits)
+    {
+      parallel_for(digits, parallel_thresholds::ntt, [&](size_t begin, size_t end)
+        {
+          for (size_t i = begin; i < end; i++)
+            dst[i] = get_digit(a, i) % f.p;
+        });
+      std::fill(dst + digits, dst + n, 0);
+    }
+
+    // dst = cyclic convolution of a and b digits modulo f.p (b == nullptr -- square)
+    void convolve(const montgomery_field &f, std::vector<uint32_t> &dst, std::vector<uint32_t> &tmp,
+                  const place_t *a, size_t ad, const place_t *b, size_t bd)
+    {
+      size_t n = dst.size();
+      std::vector<uint32_t> roots = compute_roots(f, n, false);
+      load_digits(f, dst.data(), n, a, ad);
+      forward_transform(f, dst.data(), n, roots.data());
+      if (b != nullptr)
+      {
+        load_digits(f, tmp.data(), n, b, bd);
+        forward_transform(f, tmp.data(), n, roots.data());
+      }
+      const uint32_t *other = b != nullptr ? tmp.data() : dst.data();
+      // pointwise products are (a * b / R), compensated in scaling
+      parallel_for(n, parallel_thresholds::ntt, [&](size_t begin, size_t end)
+        {
+          for (size_t i = begin; i < end; i++)
+            dst[i] = f.mul(dst[i], other[i]);
+        });
+
+      roots = compute_roots(f, n, true);
+      inverse_transform(f, dst.data(), n, roots.data());
+      uint32_t scale = f.to_montgomery(f.to_montgomery(inverse(static_cast<uint32_t>(n % f.p), f.p)));
+      parallel_for(n, parallel_thresholds::ntt, [&](size_t begin, size_t end)
+        {
+          for (size_t i = begin; i < end; i++)
+            dst[i] = f.mul(dst[i], scale);
+        });
+    }
+  }
+
+  bool ntt_fits(size_t an, size_t bn)
+  {
+    return (an + bn) * DIGITS_PER_PLACE <= MAX_LENGTH;
+  }
+
+  void ntt_mul(place_t *res, const place_t *a, size_t an, const place_t *b, size_t bn)
+  {
+    size_t ad = an * DIGITS_PER_PLACE, bd = bn * DIGITS_PER_PLACE, rd = ad + bd;
+    size_t n = 1;
+    while (n < rd)
+      n *= 2;
+
+    bool square = a == b && an == bn;
+    std::vector<uint32_t> residues[3] = {std::vector<uint32_t>(n), std::vector<uint32_t>(n),
+                                         std::vector<uint32_t>(n)};
+    std::vector<uint32_t> tmp(square ? 0 : n);
+    auto convolve_prime = [&](int k, std::vector<uint32_t> &buffer)
+    {
+      convolve(montgomery_field(PRIMES[k]), residues[k], buffer, a, ad, square ? nullptr : b, bd);
+    };
+    if (parallel_worth(n, parallel_thresholds::ntt))
+    {
+      // convolutions modulo different primes are independent
+      std::vector<uint32_t> tmp1(tmp.size()), tmp2(tmp.size());
+      task_group group;
+      group.run([&] { convolve_prime(1, tmp1); });
+      group.run([&] { convolve_prime(2, tmp2); });
+      convolve_prime(0, tmp);
+      group.wait();
+    }
+    else
+      for (int k = 0; k < 3; k++)
+        convolve_prime(k, tmp);
+
+    // Garner's algorithm: x = v0 + p0 * (v1 + p1 * v2), then x is added to the carry
+    const uint64_t p0 = PRIMES[0], p1 = PRIMES[1], p2 = PRIMES[2];
+    const uint64_t inv_p0_p1 = inverse(PRIMES[0], PRIMES[1]),
+      inv_p0p1_p2 = inverse(static_cast<uint32_t>(p0 * p1 % p2), PRIMES[2]);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < rd; i++)
+    {
+      uint64_t v0 = residues[0][i];
+      uint64_t v1 = (residues[1][i] + p1 - v0 % p1) * inv_p0_p1 % p1;
+      uint64_t v2 = (residues[2][i] + p2 - (v0 + v1 * (p0 % p2)) % p2) * inv_p0p1_p2 % p2;
+      uint64_t t = v1 + p1 * v2;
+      uint64_t low = (t & 0xFFFFFFFF) * p0 + v0 + (carry & 0xFFFFFFFF);
+      set_digit(res, i, static_cast<uint32_t>(low));
+      carry = (t >> 32) * p0 + (low >> 32) + (carry >> 32);
+    }
+  }
+} // end of 'big_int_util' namespace
@@ -0,0 +1,19 @@
+/* Nikolai Kholiavin, M3138 */
+
+#ifndef NTT_H
+#define NTT_H
+
+#include "limb_arithmetic.h"
+
+namespace big_int_util
+{
+  // checks if operands of an and bn places are not too large for ntt_mul
+  bool ntt_fits(size_t an, size_t bn);
+
+  // res[0..an + bn) = a[0..an) * b[0..bn) using number-theoretic transforms modulo
+  // three 30-bit primes and Chinese remainder theorem (Garner's algorithm),
+  // requires ntt_fits(an, bn), res must not overlap with operands
+  void ntt_mul(place_t *res, const place_t *a, size_t an, const place_t *b, size_t bn);
+} // end of 'big_int_util' namespace
+
+#endif // NTT_H
@@ -3,7 +3,7 @@
 
 namespace big_int_util
 {
-  void optimized_buffer::allocate(size_t new_size, uint32_t default_val, const uint32_t *old_data, size_t old_size)
+  void optimized_buffer::allocate(size_t new_size, place_t default_val, const place_t *old_data, size_t old_size)
   {
     set_is_dynamic_data();
     dynamic_data = shared_buffer_t::allocate(new_size, default_val, old_data, old_size);
@@ -15,7 +15,7 @@ namespace big_int_util
     unshare(size());
   }
 
-  void optimized_buffer::unshare(size_t new_size, uint32_t default_val)
+  void optimized_buffer::unshare(size_t new_size, place_t default_val)
   {
     assert(is_dynamic_data() && (new_size > dynamic_data->capacity || !dynamic_data->is_unique()));
 
@@ -26,18 +26,43 @@ namespace big_int_util
   void optimized_buffer::ensure_unique()
   {
     if (is_dynamic_data()) dynamic_data = shared_buffer_t::ensure_unique(dynamic_data, size());
+    else if (is_external_data()) internalize(size());
   }
 
-  void optimized_buffer::static_inflate(size_t new_size, uint32_t default_val)
+  void optimized_buffer::static_inflate(size_t new_size, place_t default_val)
   {
     assert(is_static_data() && new_size > STATIC_BUFFER_SIZE);
 
-    uint32_t buffer[STATIC_BUFFER_SIZE];
+    instrumentation::count_static_to_dynamic();
+    place_t buffer[STATIC_BUFFER_SIZE];
     std::copy_n(static_data, size(), buffer);
     allocate(new_size, default_val, buffer, size());
   }
 
-  optimized_buffer::optimized_buffer(size_t size, uint32_t default_val)
+  void optimized_buffer::internalize(size_t new_size, place_t default_val)
+  {
+    assert(is_external_data());
+
+    instrumentation::count_copy(true);
+    const place_t *old_data = external_data;
+    size_t old_size = size();
+    if (new_size <= STATIC_BUFFER_SIZE)
+    {
+      set_is_static_data();
+      std::copy_n(old_data, std::min(old_size, new_size), static_data);
+      if (new_size > old_size)
+      {
+        std::fill(static_data + old_size, static_data + new_size, default_val);
+      }
+      set_size(new_size);
+    }
+    else
+    {
+      allocate(new_size, default_val, old_data, old_size);
+    }
+  }
+
+  optimized_buffer::optimized_buffer(size_t size, place_t default_val)
   {
     if (size <= STATIC_BUFFER_SIZE)
     {
@@ -51,7 +76,7 @@ namespace big_int_util
     }
   }
 
-  optimized_buffer::optimized_buffer(const std::vector<uint32_t> &vec)
+  optimized_buffer::optimized_buffer(const std::vector<place_t> &vec)
   {
     if (vec.size() <= STATIC_BUFFER_SIZE)
     {
@@ -71,10 +96,39 @@ namespace big_int_util
     {
       std::copy_n(other.static_data, other.size(), static_data);
     }
-    else
+    else if (other.is_dynamic_data())
     {
       dynamic_data = other.dynamic_data->add_ref();
     }
+    else
+    {
+      external_data = other.external_data;
+    }
+  }
+
+  optimized_buffer::optimized_buffer(optimized_buffer &&other) noexcept : size_(other.size_)
+  {
+    if (other.is_static_data())
+    {
+      std::copy_n(other.static_data, other.size(), static_data);
+    }
+    else
+    {
+      copy_pointer(other);
+    }
+    other.size_ = 0;
+  }
+
+  optimized_buffer optimized_buffer::adopt(const place_t *places, size_t size)
+  {
+    optimized_buffer res(0, 0);
+    if (size != 0)
+    {
+      res.set_is_external_data();
+      res.external_data = places;
+      res.set_size(size);
+    }
+    return res;
   }
 
   optimized_buffer &optimized_buffer::operator=(const optimized_buffer &other)
@@ -87,15 +141,42 @@ namespace big_int_util
     return *this;
   }
 
-  void optimized_buffer::swap_static_dynamic_data(optimized_buffer &other)
+  optimized_buffer &optimized_buffer::operator=(optimized_buffer &&other) noexcept
   {
-    assert(is_static_data());
-    shared_buffer_t *tmp = other.dynamic_data;
+    if (this == &other)
+    {
+      return *this;
+    }
+    optimized_buffer(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  void optimized_buffer::copy_pointer(const optimized_buffer &other) noexcept
+  {
+    assert(!other.is_static_data());
+    if (other.is_dynamic_data())
+    {
+      dynamic_data = other.dynamic_data;
+    }
+    else
+    {
+      external_data = other.external_data;
+    }
+  }
+
+  void optimized_buffer::swap_static_dynamic_data(optimized_buffer &other) noexcept
+  {
+    assert(is_static_data() && !other.is_static_data());
+    // the pointer is saved to a buffer in its own state before the places overwrite it
+    optimized_buffer tmp(0, 0);
+    tmp.size_ = other.size_ & FLAGS_MASK;
+    tmp.copy_pointer(other);
     std::copy_n(static_data, size(), other.static_data);
-    dynamic_data = tmp;
+    copy_pointer(tmp);
+    tmp.size_ = 0;
   }
 
-  void optimized_buffer::swap(optimized_buffer &other)
+  void optimized_buffer::swap(optimized_buffer &other) noexcept
   {
     if (this == &other)
     {
@@ -106,7 +187,11 @@ namespace big_int_util
     {
       if (other.is_static_data())
       {
-        std::swap(static_data, other.static_data);
+        // only used places are swapped, the rest may be uninitialized
+        place_t buffer[STATIC_BUFFER_SIZE];
+        std::copy_n(static_data, size(), buffer);
+        std::copy_n(other.static_data, other.size(), static_data);
+        std::copy_n(buffer, size(), other.static_data);
       }
       else
       {
@@ -119,15 +204,24 @@ namespace big_int_util
       {
         other.swap_static_dynamic_data(*this);
       }
-      else
+      else if (is_dynamic_data() && other.is_dynamic_data())
       {
         std::swap(dynamic_data, other.dynamic_data);
       }
+      else
+      {
+        optimized_buffer tmp(0, 0);
+        tmp.size_ = size_ & FLAGS_MASK;
+        tmp.copy_pointer(*this);
+        copy_pointer(other);
+        other.copy_pointer(tmp);
+        tmp.size_ = 0;
+      }
     }
     std::swap(size_, other.size_);
   }
 
-  void optimized_buffer::resize(size_t new_size, uint32_t default_val)
+  void optimized_buffer::resize(size_t new_size, place_t default_val)
   {
     if (new_size <= size())
     {
@@ -135,7 +229,11 @@ namespace big_int_util
       return;
     }
 
-    if (is_static_data() && new_size > STATIC_BUFFER_SIZE)
+    if (is_external_data())
+    {
+      internalize(new_size, default_val);
+    }
+    else if (is_static_data() && new_size > STATIC_BUFFER_SIZE)
     {
       static_inflate(new_size, default_val);
     }
@@ -145,28 +243,23 @@ namespace big_int_util
     }
     else
     {
-      uint32_t *data = is_static_data() ? static_data : dynamic_data->data;
+      place_t *data = this->data();
       std::fill(data + size(), data + new_size, default_val);
       set_size(new_size);
     }
   }
 
-  uint32_t optimized_buffer::back() const
+  place_t optimized_buffer::back() const
   {
     return data()[size() - 1];
   }
 
-  uint32_t & optimized_buffer::back()
+  place_t & optimized_buffer::back()
   {
-    if (is_static_data())
-    {
-      return static_data[size() - 1];
-    }
-    ensure_unique();
-    return dynamic_data->data[size() - 1];
+    return data()[size() - 1];
   }
 
-  void optimized_buffer::push_back(uint32_t val)
+  void optimized_buffer::push_back(place_t val)
   {
     resize(size() + 1, val);
   }
@@ -176,25 +269,35 @@ namespace big_int_util
     resize(size() - 1);
   }
 
-  optimized_buffer::operator const uint32_t *() const
+  optimized_buffer::operator const place_t *() const
   {
     return data();
   }
 
-  optimized_buffer::operator uint32_t *()
+  optimized_buffer::operator place_t *()
   {
     return data();
   }
 
-  const uint32_t * optimized_buffer::data() const
+  const place_t * optimized_buffer::data() const
   {
+    if (is_external_data())
+    {
+      return external_data;
+    }
     return is_static_data() ? static_data : dynamic_data->data;
   }
 
-  uint32_t * optimized_buffer::data()
+  place_t * optimized_buffer::data()
   {
     ensure_unique();
-    return is_static_data() ? static_data : dynamic_data->data;
+    if (is_static_data())
+    {
+      return static_data;
+    }
+    // places may be modified through the pointer
+    dynamic_data->hash.clear();
+    return dynamic_data->data;
   }
 
   optimized_buffer::iterator optimized_buffer::begin()
@@ -227,7 +330,23 @@ namespace big_int_util
     {
       return false;
     }
-    return std::equal(begin(), end(), other.begin());
+    const place_t *places = data(), *other_places = other.data();
+    return places == other_places || std::equal(places, places + size(), other_places);
+  }
+
+  uint64_t optimized_buffer::hash() const
+  {
+    uint64_t res;
+    if (is_dynamic_data() && dynamic_data->hash.get(size(), res))
+    {
+      return res;
+    }
+    res = hash_n(data(), size());
+    if (is_dynamic_data())
+    {
+      dynamic_data->hash.set(size(), res);
+    }
+    return res;
   }
 
   bool optimized_buffer::operator!=(const optimized_buffer &other) const
@@ -5,41 +5,133 @@
 
 #include <cassert>
 #include <algorithm>
+#include <utility>
 #include <cstdint>
 #include <vector>
 #include <limits>
+#include <new>
+#ifdef BIGINT_ATOMIC_REFCOUNT
+#include <atomic>
+#endif
+
+#include "limb_arithmetic.h"
+#include "place_pool.h"
+#include "instrumentation.h"
+
+// number of places stored inline (without allocation), at least as many as fit into a pointer
+#ifndef BIGINT_INLINE_PLACES
+#define BIGINT_INLINE_PLACES 0
+#endif
 
 namespace big_int_util
 {
+  /* Reference counter of shared buffers, atomic if BIGINT_ATOMIC_REFCOUNT is defined */
+#ifdef BIGINT_ATOMIC_REFCOUNT
+  class ref_counter
+  {
+  private:
+    std::atomic<size_t> count;
+
+  public:
+    explicit ref_counter(size_t count) : count(count) {}
+
+    // a new reference is made from an existing one, so no ordering is needed
+    void acquire() { count.fetch_add(1, std::memory_order_relaxed); }
+
+    // returns true if the last reference is released, all accesses through
+    // other references happen before that
+    bool release() { return count.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+    bool is_unique() const { return count.load(std::memory_order_acquire) == 1; }
+  };
+#else
+  class ref_counter
+  {
+  private:
+    size_t count;
+
+  public:
+    explicit ref_counter(size_t count) : count(count) {}
+
+    void acquire() { count++; }
+    bool release() { return --count == 0; }
+    bool is_unique() const { return count == 1; }
+  };
+#endif
+
+  /* Hash of shared places, valid until they are modified: copies hash in O(1) */
+#ifdef BIGINT_ATOMIC_REFCOUNT
+  // copies may be hashed concurrently, so nothing is cached
+  class hash_cache
+  {
+  public:
+    bool get(size_t, uint64_t &) const { return false; }
+    void set(size_t, uint64_t) {}
+    void clear() {}
+  };
+#else
+  class hash_cache
+  {
+  private:
+    // hash of the first 'size' places, 0 if none
+    size_t size = 0;
+    uint64_t value = 0;
+
+  public:
+    bool get(size_t places, uint64_t &hash) const
+    {
+      hash = value;
+      return size == places && places != 0;
+    }
+
+    void set(size_t places, uint64_t hash)
+    {
+      size = places;
+      value = hash;
+    }
+
+    void clear() { size = 0; }
+  };
+#endif
+
   /* Shared buffer (copy-on-write optimization) */
   template<typename place_t>
   struct shared_buffer
   {
-    size_t ref_count;
+    ref_counter ref_count;
     size_t capacity;
+    hash_cache hash;
     place_t data[];
 
+    static size_t block_bytes(size_t capacity)
+    {
+      return sizeof(shared_buffer) + sizeof(place_t) * capacity;
+    }
+
     static shared_buffer * allocate_buffer(size_t capacity)
     {
-      shared_buffer *self = static_cast<shared_buffer *>(operator new(sizeof(shared_buffer) +
-                                                                      sizeof(place_t) * capacity));
-      self->ref_count = 1;
-      self->capacity = capacity;
+      // the whole pool block is used, so capacity may grow
+      size_t bytes = place_pool::block_size(block_bytes(capacity));
+      shared_buffer *self = static_cast<shared_buffer *>(place_pool::allocate(bytes));
+      new (&self->ref_count) ref_counter(1);
+      new (&self->hash) hash_cache();
+      self->capacity = (bytes - sizeof(shared_buffer)) / sizeof(place_t);
+      instrumentation::count_allocation(self->capacity);
       return self;
     }
 
     shared_buffer * add_ref()
     {
-      ref_count++;
+      ref_count.acquire();
       return this;
     }
 
     bool is_unique()
     {
-      return ref_count == 1;
+      return ref_count.is_unique();
     }
 
-    static shared_buffer * allocate(size_t new_size, uint32_t default_val, const uint32_t *old_data, size_t old_size)
+    static shared_buffer * allocate(size_t new_size, place_t default_val, const place_t *old_data, size_t old_size)
     {
       shared_buffer *res = allocate_buffer(new_size > old_size ? std::max(old_size * 3 / 2, new_size) : new_size);
       if (old_data != nullptr)
@@ -53,8 +145,9 @@ namespace big_int_util
       return res;
     }
 
-    static shared_buffer * unshare(shared_buffer *self, size_t size, size_t new_size, uint32_t default_val)
+    static shared_buffer * unshare(shared_buffer *self, size_t size, size_t new_size, place_t default_val)
     {
+      instrumentation::count_copy(!self->is_unique());
       shared_buffer *res = allocate(new_size, default_val, self->data, size);
       release(self);
       return res;
@@ -72,26 +165,33 @@ namespace big_int_util
       {
         return;
       }
-      if (--self->ref_count == 0)
+      if (self->ref_count.release())
       {
-        operator delete(self);
+        instrumentation::count_free(self->capacity);
+        place_pool::deallocate(self, block_bytes(self->capacity));
       }
     }
   };
 
-  /* uint32_t buffer (small-object & copy-on-write optimizations) */
+  /* Place buffer (small-object & copy-on-write optimizations) */
   class optimized_buffer
   {
   private:
-    using shared_buffer_t = shared_buffer<uint32_t>;
+    using shared_buffer_t = shared_buffer<place_t>;
 
-    static constexpr size_t STATIC_BUFFER_SIZE = sizeof(shared_buffer_t *) / sizeof(uint32_t);
+    static constexpr size_t POINTER_PLACES = sizeof(shared_buffer_t *) / sizeof(place_t);
+    static constexpr size_t STATIC_BUFFER_SIZE =
+      BIGINT_INLINE_PLACES > POINTER_PLACES ? BIGINT_INLINE_PLACES : POINTER_PLACES;
     static constexpr size_t STATE_MASK = size_t{1} << (std::numeric_limits<size_t>::digits - 1);
+    static constexpr size_t EXTERNAL_MASK = STATE_MASK >> 1;
+    static constexpr size_t FLAGS_MASK = STATE_MASK | EXTERNAL_MASK;
 
+    // external data is adopted places not owned by the buffer (see adopt)
     union
     {
-      uint32_t static_data[STATIC_BUFFER_SIZE];
+      place_t static_data[STATIC_BUFFER_SIZE];
       shared_buffer_t *dynamic_data;
+      const place_t *external_data;
     };
     size_t size_ = 0;
 
@@ -100,70 +200,97 @@ namespace big_int_util
       return size_ & STATE_MASK;
     }
 
+    bool is_external_data() const
+    {
+      return size_ & EXTERNAL_MASK;
+    }
+
     bool is_static_data() const
     {
-      return !is_dynamic_data();
+      return !(size_ & FLAGS_MASK);
     }
 
     void set_is_static_data()
     {
-      size_ &= ~STATE_MASK;
+      size_ &= ~FLAGS_MASK;
     }
 
     void set_is_dynamic_data()
     {
-      size_ |= STATE_MASK;
+      size_ = (size_ & ~FLAGS_MASK) | STATE_MASK;
+    }
+
+    void set_is_external_data()
+    {
+      size_ = (size_ & ~FLAGS_MASK) | EXTERNAL_MASK;
     }
 
     void set_size(size_t new_size)
     {
-      size_ = new_size | (size_ & STATE_MASK);
+      size_ = new_size | (size_ & FLAGS_MASK);
     }
 
-    void allocate(size_t new_size, uint32_t default_val = 0, const uint32_t *old_data = nullptr, size_t old_size = 0);
-    void unshare(size_t new_size, uint32_t default_val = 0);
+    void allocate(size_t new_size, place_t default_val = 0, const place_t *old_data = nullptr, size_t old_size = 0);
+    void unshare(size_t new_size, place_t default_val = 0);
     void unshare();
     void ensure_unique();
-    void static_inflate(size_t new_size, uint32_t default_val = 0);
-    void swap_static_dynamic_data(optimized_buffer &other);
+    void static_inflate(size_t new_size, place_t default_val = 0);
+    // copies adopted places into own storage
+    void internalize(size_t new_size, place_t default_val = 0);
+    // takes the pointer of non-static other, the state of *this is not changed
+    void copy_pointer(const optimized_buffer &other) noexcept;
+    void swap_static_dynamic_data(optimized_buffer &other) noexcept;
 
   public:
-    using iterator = uint32_t *;
-    using const_iterator = const uint32_t *;
+    static constexpr size_t INLINE_CAPACITY = STATIC_BUFFER_SIZE;
+
+    using iterator = place_t *;
+    using const_iterator = const place_t *;
 
-    optimized_buffer(size_t size, uint32_t default_val);
-    optimized_buffer(const std::vector<uint32_t> &vec);
+    optimized_buffer(size_t size, place_t default_val);
+    optimized_buffer(const std::vector<place_t> &vec);
     optimized_buffer(const optimized_buffer &other);
+    // moved-from buffer is left empty
+    optimized_buffer(optimized_buffer &&other) noexcept;
+
+    // uses places[0..size) without copying: they are only read (copied on the first
+    // modification or growth), so they must stay unchanged while any copy of the buffer uses them
+    static optimized_buffer adopt(const place_t *places, size_t size);
 
     optimized_buffer & operator=(const optimized_buffer &other);
-    void swap(optimized_buffer &other);
+    optimized_buffer & operator=(optimized_buffer &&other) noexcept;
+    void swap(optimized_buffer &other) noexcept;
 
     size_t size() const
     {
-      return size_ & ~STATE_MASK;
+      return size_ & ~FLAGS_MASK;
     }
 
-    void resize(size_t new_size, uint32_t default_val = 0);
+    void resize(size_t new_size, place_t default_val = 0);
 
-    uint32_t back() const;
-    uint32_t & back();
+    place_t back() const;
+    place_t & back();
 
-    void push_back(uint32_t val);
+    void push_back(place_t val);
     void pop_back();
 
-    operator const uint32_t *() const;
-    operator uint32_t *();
-    const uint32_t * data() const;
-    uint32_t * data();
+    operator const place_t *() const;
+    operator place_t *();
+    const place_t * data() const;
+    place_t * data();
 
     iterator begin();
     const_iterator begin() const;
     iterator end();
     const_iterator end() const;
 
+    // copies sharing places are equal without comparing them
     bool operator==(const optimized_buffer &other) const;
     bool operator!=(const optimized_buffer &other) const;
 
+    // hash of places (see hash_n), cached in shared places until they are modified
+    uint64_t hash() const;
+
     ~optimized_buffer();
   };
 }
@@ -0,0 +1,183 @@
+/* Nikolai Kholiavin, M3138 */
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "parallel.h"
+
+namespace big_int_util
+{
+  size_t parallel_thresholds::mul = 1000;
+  size_t parallel_thresholds::ntt = size_t{1} << 15;
+  size_t parallel_thresholds::conversion = 2000;
+
+  // a single queue for all groups: workers take the oldest tasks (the largest parts of an operation),
+  // waiting threads take the newest ones
+  struct thread_pool
+  {
+    struct task
+    {
+      std::function<void()> f;
+      task_group *group;
+    };
+
+    std::mutex mutex;
+    // signalled when a task is queued, a group is done or workers are stopped
+    std::condition_variable changed;
+    std::deque<task> tasks;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+
+    ~thread_pool()
+    {
+      resize(0);
+    }
+
+    void resize(size_t count)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+      }
+      changed.notify_all();
+      for (std::thread &worker : workers)
+        worker.join();
+      workers.clear();
+      stopping = false;
+      for (size_t i = 0; i < count; i++)
+        workers.emplace_back([this] { work(); });
+    }
+
+    void work()
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (true)
+      {
+        changed.wait(lock, [this] { return stopping || !tasks.empty(); });
+        if (stopping)
+          return;
+        task t = std::move(tasks.front());
+        tasks.pop_front();
+        execute(t, lock);
+      }
+    }
+
+    // runs a task taken from the queue, the lock is released meanwhile
+    void execute(task &t, std::unique_lock<std::mutex> &lock)
+    {
+      lock.unlock();
+      std::exception_ptr error;
+      try
+      {
+        t.f();
+      }
+      catch (...)
+      {
+        error = std::current_exception();
+      }
+      // the task is destroyed before its group can be
+      t.f = nullptr;
+      lock.lock();
+      if (error && !t.group->error)
+        t.group->error = error;
+      if (--t.group->pending == 0)
+        changed.notify_all();
+    }
+
+    void push(std::function<void()> f, task_group *group)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(task{std::move(f), group});
+        group->pending++;
+      }
+      changed.notify_one();
+    }
+
+    void wait(task_group *group)
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (group->pending != 0)
+      {
+        if (tasks.empty())
+        {
+          changed.wait(lock);
+          continue;
+        }
+        task t = std::move(tasks.back());
+        tasks.pop_back();
+        execute(t, lock);
+      }
+    }
+  };
+
+  namespace
+  {
+    thread_pool & pool()
+    {
+      static thread_pool instance;
+      return instance;
+    }
+
+    size_t thread_count = 1;
+  }
+
+  void set_parallel_threads(size_t threads)
+  {
+    if (threads == 0)
+      threads = std::max(std::thread::hardware_concurrency(), 1u);
+    if (threads == thread_count)
+      return;
+    pool().resize(threads - 1);
+    thread_count = threads;
+  }
+
+  size_t parallel_threads()
+  {
+    return thread_count;
+  }
+
+  task_group::~task_group()
+  {
+    try
+    {
+      wait();
+    }
+    catch (...)
+    {}
+  }
+
+  void task_group::run(std::function<void()> task)
+  {
+    if (thread_count <= 1)
+    {
+      try
+      {
+        task();
+      }
+      catch (...)
+      {
+        if (!error)
+          error = std::current_exception();
+      }
+      return;
+    }
+    pool().push(std::move(task), this);
+  }
+
+  void task_group::wait()
+  {
+    // without threads nothing is queued
+    if (thread_count > 1)
+      pool().wait(this);
+    if (error)
+    {
+      std::exception_ptr e = error;
+      error = nullptr;
+      std::rethrow_exception(e);
+    }
+  }
+} // end of 'big_int_util' namespace
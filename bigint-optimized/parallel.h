@@ -0,0 +1,86 @@
+/* Nikolai Kholiavin, M3138 */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <functional>
+
+namespace big_int_util
+{
+  /***
+   * Opt-in parallel execution of large multiplications and conversions: independent parts of
+   * an operation are run by a pool of worker threads, parts below the grain sizes stay on the
+   * calling thread. Threads are off by default (a single thread).
+   ***/
+
+  /* Grain sizes, tunable */
+  struct parallel_thresholds
+  {
+    // products of operands with at least this many places are split between threads
+    static size_t mul;
+    // transforms of at least this many points are split between threads
+    static size_t ntt;
+    // numbers of at least this many places are converted to digits by parts in parallel
+    static size_t conversion;
+  };
+
+  // sets the number of threads of a single operation including the calling one
+  // (0 -- hardware concurrency, 1 -- off), must not be called concurrently with arithmetic
+  void set_parallel_threads(size_t threads);
+  size_t parallel_threads();
+
+  // true if a part of 'size' is worth running in parallel with grain 'grain'
+  inline bool parallel_worth(size_t size, size_t grain)
+  {
+    return size >= grain && parallel_threads() > 1;
+  }
+
+  // fork-join group: tasks are queued for worker threads, wait() returns when all of them are done
+  // (the waiting thread runs queued tasks meanwhile) and rethrows the first exception thrown by them;
+  // tasks are run at once by run() if threads are off
+  class task_group
+  {
+  public:
+    task_group() = default;
+    task_group(const task_group &) = delete;
+    task_group & operator=(const task_group &) = delete;
+    // waits for the tasks (their exceptions are dropped)
+    ~task_group();
+
+    void run(std::function<void()> task);
+    void wait();
+
+  private:
+    friend struct thread_pool;
+
+    // guarded by the pool
+    size_t pending = 0;
+    std::exception_ptr error;
+  };
+
+  // f(begin, end) for parts of [0, n) of at least 'grain' elements, one part per thread
+  template<typename F>
+  void parallel_for(size_t n, size_t grain, F f)
+  {
+    size_t parts = std::min(parallel_threads(), n / std::max(grain, size_t{1}));
+    if (parts <= 1)
+    {
+      f(size_t{0}, n);
+      return;
+    }
+    size_t step = (n + parts - 1) / parts;
+    task_group group;
+    for (size_t begin = step; begin < n; begin += step)
+    {
+      size_t end = std::min(n, begin + step);
+      group.run([&f, begin, end] { f(begin, end); });
+    }
+    f(size_t{0}, step);
+    group.wait();
+  }
+} // end of 'big_int_util' namespace
+
+#endif // PARALLEL_H
@@ -0,0 +1,158 @@
+/* Nikolai Kholiavin, M3138 */
+
+#include <new>
+
+#include "place_pool.h"
+
+namespace big_int_util
+{
+  namespace
+  {
+    // block sizes MIN_POOLED_BLOCK * 2^i up to MAX_POOLED_BLOCK
+    constexpr size_t SIZE_CLASSES = 8;
+    static_assert(place_pool::MIN_POOLED_BLOCK << (SIZE_CLASSES - 1) == place_pool::MAX_POOLED_BLOCK,
+                  "size classes must cover pooled block sizes");
+
+    struct free_block
+    {
+      free_block *next;
+    };
+
+    size_t size_class(size_t bytes)
+    {
+      size_t index = 0;
+      for (size_t size = place_pool::MIN_POOLED_BLOCK; size < bytes; size *= 2)
+        index++;
+      return index;
+    }
+
+    struct thread_cache
+    {
+      free_block *heads[SIZE_CLASSES] = {};
+      size_t counts[SIZE_CLASSES] = {};
+      size_t arena_depth = 0;
+      place_pool::statistics stats = {};
+
+      void release()
+      {
+        for (size_t i = 0; i < SIZE_CLASSES; i++)
+        {
+          while (heads[i] != nullptr)
+          {
+            free_block *next = heads[i]->next;
+            operator delete(heads[i]);
+            heads[i] = next;
+            stats.system_deallocations++;
+          }
+          counts[i] = 0;
+        }
+        stats.cached_blocks = 0;
+      }
+
+      ~thread_cache();
+    };
+
+    // set when the cache of a thread is destroyed: numbers destroyed later at its exit
+    // (e.g. static ones of the main thread) return their blocks directly to operator delete
+    thread_local bool cache_destroyed = false;
+    thread_local thread_cache cache;
+
+    thread_cache::~thread_cache()
+    {
+      release();
+      cache_destroyed = true;
+    }
+  }
+
+  size_t place_pool::block_size(size_t bytes)
+  {
+    if (bytes > MAX_POOLED_BLOCK)
+      return bytes;
+    size_t size = MIN_POOLED_BLOCK;
+    while (size < bytes)
+      size *= 2;
+    return size;
+  }
+
+  void * place_pool::allocate(size_t bytes)
+  {
+    bytes = block_size(bytes);
+    if (cache_destroyed)
+      return operator new(bytes);
+    if (bytes <= MAX_POOLED_BLOCK)
+    {
+      size_t index = size_class(bytes);
+      if (free_block *block = cache.heads[index])
+      {
+        cache.heads[index] = block->next;
+        cache.counts[index]--;
+        cache.stats.cached_blocks--;
+        cache.stats.pooled_allocations++;
+        return block;
+      }
+    }
+    void *block = operator new(bytes);
+    cache.stats.system_allocations++;
+    return block;
+  }
+
+  void place_pool::deallocate(void *block, size_t bytes)
+  {
+    bytes = block_size(bytes);
+    if (cache_destroyed)
+    {
+      operator delete(block);
+      return;
+    }
+    if (bytes <= MAX_POOLED_BLOCK)
+    {
+      size_t index = size_class(bytes);
+      if (cache.counts[index] < MAX_CACHED_BLOCKS || cache.arena_depth > 0)
+      {
+        free_block *head = new (block) free_block;
+        head->next = cache.heads[index];
+        cache.heads[index] = head;
+        cache.counts[index]++;
+        cache.stats.cached_blocks++;
+        cache.stats.pooled_deallocations++;
+        return;
+      }
+    }
+    operator delete(block);
+    cache.stats.system_deallocations++;
+  }
+
+  void place_pool::release_cached()
+  {
+    if (!cache_destroyed)
+      cache.release();
+  }
+
+  place_pool::statistics place_pool::get_statistics()
+  {
+    return cache_destroyed ? statistics{} : cache.stats;
+  }
+
+  void place_pool::reset_statistics()
+  {
+    if (cache_destroyed)
+      return;
+    size_t cached = cache.stats.cached_blocks;
+    cache.stats = statistics{};
+    cache.stats.cached_blocks = cached;
+  }
+
+  scoped_arena::scoped_arena()
+  {
+    if (!cache_destroyed)
+      cache.arena_depth++;
+  }
+
+  scoped_arena::~scoped_arena()
+  {
+    if (cache_destroyed)
+      return;
+    if (--cache.arena_depth == 0)
+      cache.release();
+  }
+} // end of 'big_int_util' namespace
@@ -0,0 +1,66 @@
+/* Nikolai Kholiavin, M3138 */
+
+#ifndef PLACE_POOL_H
+#define PLACE_POOL_H
+
+#include <cstddef>
+
+namespace big_int_util
+{
+  /***
+   * Size-class pool for place storage of shared buffers:
+   * blocks of power of two sizes up to MAX_POOLED_BLOCK bytes are kept
+   * in thread-local free lists after deallocation and reused, larger
+   * blocks go directly to operator new/delete.
+   * A block may be deallocated by any thread, it goes to that thread's lists.
+   ***/
+  namespace place_pool
+  {
+    static constexpr size_t MIN_POOLED_BLOCK = 32;
+    static constexpr size_t MAX_POOLED_BLOCK = 4096;
+    // free blocks kept per size class (not limited inside of a scoped_arena)
+    static constexpr size_t MAX_CACHED_BLOCKS = 64;
+
+    // size of the block actually allocated for a request of 'bytes'
+    size_t block_size(size_t bytes);
+
+    // 'bytes' must be the same in allocation and deallocation of a block
+    void * allocate(size_t bytes);
+    void deallocate(void *block, size_t bytes);
+
+    // releases all free blocks cached by the calling thread
+    void release_cached();
+
+    /* Allocation statistics of the calling thread */
+    struct statistics
+    {
+      // blocks taken from operator new and returned to operator delete
+      size_t system_allocations, system_deallocations;
+      // blocks reused from and returned to free lists
+      size_t pooled_allocations, pooled_deallocations;
+      // blocks currently in free lists
+      size_t cached_blocks;
+    };
+
+    statistics get_statistics();
+    void reset_statistics();
+  } // end of 'place_pool' namespace
+
+  /***
+   * Scope of a batch of computations on the calling thread: while it is alive
+   * all freed pooled blocks are cached (so temporaries of the batch are
+   * allocated only once), at its end all cached blocks are released at once.
+   * Numbers are not bound to the scope, they may outlive it.
+   * Scopes may be nested, blocks are released by the outermost one.
+   ***/
+  class scoped_arena
+  {
+  public:
+    scoped_arena();
+    scoped_arena(const scoped_arena &) = delete;
+    scoped_arena & operator=(const scoped_arena &) = delete;
+    ~scoped_arena();
+  };
+} // end of 'big_int_util' namespace
+
+#endif // PLACE_POOL_H
@@ -9,6 +9,7 @@
 #include <vector>
 #include <string>
 #include <functional>
+#include <limits>
 
 struct big_integer
 {
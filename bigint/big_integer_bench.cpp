@@ -0,0 +1,172 @@
+/* Nikolai Kholiavin, M3138 */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "big_integer.h"
+#include "big_integer_gmp.h"
+
+namespace
+{
+  std::mt19937 rng(42);
+
+  // random non-negative number of at most 'places' 32-bit places (built in O(n log n) time)
+  big_integer random_big(size_t places)
+  {
+    if (places == 1)
+      return big_integer(static_cast<int>(rng() >> 1)) << 1 | big_integer(static_cast<int>(rng() & 1));
+    size_t half = places / 2;
+    return random_big(places - half) << static_cast<int>(half * 32) | random_big(half);
+  }
+
+  big_integer_gmp random_gmp(size_t places)
+  {
+    big_integer_gmp res;
+    res.random(places * 32 - 1, rng);
+    return res < 0 ? -res : res;
+  }
+
+  // average time of f in nanoseconds, repeated for at least 'min_time' seconds
+  template<typename F>
+  double measure(F f, double min_time = 0.2)
+  {
+    using clock = std::chrono::steady_clock;
+    f();
+    size_t runs = 0;
+    auto start = clock::now();
+    std::chrono::duration<double> elapsed{0};
+    do
+    {
+      f();
+      runs++;
+      elapsed = clock::now() - start;
+    } while (elapsed.count() < min_time);
+    return elapsed.count() * 1e9 / runs;
+  }
+
+  /* Sweep of all operations over operand sizes against GMP, reported as JSON */
+  struct sweep_options
+  {
+    size_t max_limbs = 100000;
+    double min_time = 0.1;
+    // larger sizes of an operation are skipped once they are expected
+    // (with quadratic growth) to take longer than this, in seconds
+    double max_op_time = 1.0;
+  };
+
+  class sweep
+  {
+  public:
+    explicit sweep(const sweep_options &options) : options(options)
+    {}
+
+    // operand sizes are in 32-bit limbs, whatever places the implementation uses
+    void run(const char *implementation, int place_bits)
+    {
+      static const size_t sizes[] = {1, 4, 16, 64, 256, 1024, 4096, 16384, 65536, 100000};
+      std::printf("{\n  \"implementation\": \"%s\",\n  \"place_bits\": %d,\n  \"limb_bits\": 32,\n"
+                  "  \"min_time_s\": %g,\n  \"results\": [", implementation, place_bits, options.min_time);
+      for (size_t limbs : sizes)
+      {
+        if (limbs > options.max_limbs)
+          break;
+        run_size(limbs);
+      }
+      std::printf("\n  ]\n}\n");
+    }
+
+  private:
+    struct operation_state
+    {
+      size_t limbs = 0;
+      double ns = 0;
+      bool skipped = false;
+    };
+
+    sweep_options options;
+    std::vector<operation_state> states;
+    size_t current_operation = 0, current_limbs = 0;
+    bool first_result = true;
+
+    void run_size(size_t limbs)
+    {
+      current_limbs = limbs;
+      current_operation = 0;
+
+      // divisor has 'limbs' limbs, dividend twice as many
+      big_integer a = random_big(limbs), b = random_big(limbs), wide = random_big(2 * limbs);
+      big_integer_gmp ga = random_gmp(limbs), gb = random_gmp(limbs), gwide = random_gmp(2 * limbs);
+      big_integer close = a ^ big_integer(1);
+      big_integer_gmp gclose = ga ^ big_integer_gmp(1);
+      // decimal strings of the same length for both (GMP prints fast)
+      std::string str = to_string(ga), gstr = str;
+
+      operation("add", [&] { return a + b; }, [&] { return ga + gb; });
+      operation("sub", [&] { return a - b; }, [&] { return ga - gb; });
+      operation("mul", [&] { return a * b; }, [&] { return ga * gb; });
+      operation("div", [&] { return wide / b; }, [&] { return gwide / gb; });
+      operation("mod", [&] { return wide % b; }, [&] { return gwide % gb; });
+      operation("shl", [&] { return a << 37; }, [&] { return ga << 37; });
+      operation("shr", [&] { return a >> 37; }, [&] { return ga >> 37; });
+      operation("and", [&] { return a & b; }, [&] { return ga & gb; });
+      operation("or", [&] { return a | b; }, [&] { return ga | gb; });
+      operation("xor", [&] { return a ^ b; }, [&] { return ga ^ gb; });
+      operation("cmp", [&] { return a < close; }, [&] { return ga < gclose; });
+      operation("to_string", [&] { return to_string(a); }, [&] { return to_string(ga); });
+      operation("from_string", [&] { return big_integer(str); }, [&] { return big_integer_gmp(gstr); });
+    }
+
+    template<typename F, typename G>
+    void operation(const char *name, F f, G g)
+    {
+      if (states.size() <= current_operation)
+        states.resize(current_operation + 1);
+      operation_state &state = states[current_operation++];
+      if (state.skipped)
+        return;
+      double growth = static_cast<double>(current_limbs) / std::max(state.limbs, size_t{1});
+      if (state.limbs != 0 && state.ns * growth * growth > options.max_op_time * 1e9)
+      {
+        state.skipped = true;
+        return;
+      }
+
+      double ns = measure(f, options.min_time), gmp_ns = measure(g, options.min_time);
+      state.limbs = current_limbs;
+      state.ns = ns;
+      std::printf("%s\n    {\"operation\": \"%s\", \"limbs\": %zu, \"ns_per_op\": %.1f, "
+                  "\"gmp_ns_per_op\": %.1f, \"ratio_to_gmp\": %.3f}",
+                  first_result ? "" : ",", name, current_limbs, ns, gmp_ns, ns / gmp_ns);
+      std::fflush(stdout);
+      first_result = false;
+    }
+  };
+}
+
+// usage: big_integer_bench [--max-limbs N] [--min-time S] [--max-op-time S]
+// prints JSON results of the sweep
+int main(int argc, char *argv[])
+{
+  sweep_options options;
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "--max-limbs") == 0 && i + 1 < argc)
+      options.max_limbs = std::strtoul(argv[++i], nullptr, 10);
+    else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+      options.min_time = std::strtod(argv[++i], nullptr);
+    else if (std::strcmp(argv[i], "--max-op-time") == 0 && i + 1 < argc)
+      options.max_op_time = std::strtod(argv[++i], nullptr);
+    else
+    {
+      std::fprintf(stderr, "usage: %s [--max-limbs N] [--min-time S] [--max-op-time S]\n", argv[0]);
+      return 1;
+    }
+  }
+  sweep(options).run("bigint", 32);
+}
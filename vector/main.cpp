@@ -1,10 +1,19 @@
 #include "vector.h"
 #include "gtest/gtest.h"
 #include <unordered_set>
+#include <memory>
+#include <string>
+#include <list>
+#include <sstream>
+#include <iterator>
+#include <map>
 
 template
 struct vector<int>;
 
+template
+struct vector<int, std::allocator<int>, 4>;
+
 template<typename T>
 T const& as_const(T& obj) {
   return obj;
@@ -104,6 +113,31 @@ private:
 template<typename T>
 size_t element<T>::throw_countdown = 0;
 
+// counts copies and moves, moves do not throw
+struct movable {
+  movable(size_t val = 0) : val(val) {}
+
+  movable(movable const& rhs) : val(rhs.val) {
+    ++copies;
+  }
+
+  movable(movable&& rhs) noexcept : val(rhs.val) {
+    rhs.val = 0;
+    ++moves;
+  }
+
+  movable& operator=(movable const&) = default;
+
+  static void reset() {
+    copies = moves = 0;
+  }
+
+  size_t val;
+  static size_t copies, moves;
+};
+
+size_t movable::copies = 0, movable::moves = 0;
+
 TEST(correctness, default_ctor) {
   vector<element<int> > a;
   element<int>::expect_no_instances();
@@ -500,3 +534,531 @@ TEST(correctness, ctor_alloc) {
   EXPECT_EQ(1, b.capacity());
 }
 
+
+TEST(correctness, reallocation_moves) {
+  size_t const N = 5000;
+  vector<movable> a;
+  movable::reset();
+  for (size_t i = 0; i != N; ++i)
+    a.push_back(movable(i));
+  a.shrink_to_fit();
+  EXPECT_EQ(0, movable::copies);
+  for (size_t i = 0; i != N; ++i)
+    EXPECT_EQ(i, a[i].val);
+}
+
+TEST(correctness, push_back_lvalue_copies_once) {
+  vector<movable> a;
+  movable x(42);
+  for (size_t i = 0; i != 100; ++i) {
+    movable::reset();
+    a.push_back(x);
+    EXPECT_EQ(1, movable::copies);
+  }
+}
+
+TEST(correctness, push_back_move_from_self) {
+  vector<vector<int> > a;
+  vector<int> b;
+  b.push_back(42);
+  a.push_back(b);
+  a.shrink_to_fit();
+  a.push_back(std::move(a[0]));
+  ASSERT_EQ(2, a.size());
+  EXPECT_TRUE(a[0].empty());
+  ASSERT_EQ(1, a[1].size());
+  EXPECT_EQ(42, a[1][0]);
+}
+
+TEST(correctness, emplace_back) {
+  size_t const N = 500;
+  {
+    vector<std::pair<element<size_t>, std::string> > a;
+    for (size_t i = 0; i != N; ++i)
+      a.emplace_back(i, std::string(i % 20, 'a'));
+    for (size_t i = 0; i != N; ++i) {
+      EXPECT_EQ(i, a[i].first);
+      EXPECT_EQ(std::string(i % 20, 'a'), a[i].second);
+    }
+  }
+  element<size_t>::expect_no_instances();
+}
+
+TEST(correctness, move_only) {
+  vector<std::unique_ptr<size_t> > a;
+  for (size_t i = 0; i != 100; ++i)
+    a.emplace_back(new size_t(i));
+  a.shrink_to_fit();
+  vector<std::unique_ptr<size_t> > b = std::move(a);
+  EXPECT_TRUE(a.empty());
+  for (size_t i = 0; i != b.size(); ++i)
+    EXPECT_EQ(i, *b[i]);
+}
+
+TEST(correctness, nested_relocation) {
+  vector<vector<std::string> > a;
+  for (size_t i = 0; i != 100; ++i) {
+    vector<std::string> v;
+    v.push_back(std::string(i, 'x'));
+    a.push_back(std::move(v));
+  }
+  for (size_t i = 0; i != a.size(); ++i)
+    EXPECT_EQ(std::string(i, 'x'), a[i][0]);
+}
+
+TEST(correctness, sized_ctor) {
+  {
+    vector<element<size_t> > a(100);
+    EXPECT_EQ(100, a.size());
+    EXPECT_EQ(100, a.capacity());
+    vector<element<size_t> > b(50, 42);
+    EXPECT_EQ(50, b.capacity());
+    for (size_t i = 0; i != b.size(); ++i)
+      EXPECT_EQ(42, b[i]);
+  }
+  element<size_t>::expect_no_instances();
+}
+
+TEST(correctness, sized_ctor_throw) {
+  element<size_t> val(42);
+  element<size_t>::set_throw_countdown(7);
+  EXPECT_THROW({
+      vector<element<size_t> > a(10, val);
+  }, std::runtime_error);
+}
+
+TEST(correctness, range_ctor) {
+  std::list<int> l;
+  for (int i = 0; i != 100; ++i)
+    l.push_back(i);
+  vector<int> a(l.begin(), l.end());
+  ASSERT_EQ(100, a.size());
+  EXPECT_EQ(100, a.capacity());
+  for (int i = 0; i != 100; ++i)
+    EXPECT_EQ(i, a[i]);
+
+  vector<int> b(3, 5);
+  ASSERT_EQ(3, b.size());
+  EXPECT_EQ(5, b[2]);
+}
+
+TEST(correctness, assign) {
+  {
+    vector<element<size_t> > a;
+    for (size_t i = 0; i != 10; ++i)
+      a.push_back(i);
+    a.assign(20, a[3]);
+    ASSERT_EQ(20, a.size());
+    for (size_t i = 0; i != a.size(); ++i)
+      EXPECT_EQ(3, a[i]);
+
+    std::list<element<size_t> > l(5, element<size_t>(7));
+    a.assign(l.begin(), l.end());
+    ASSERT_EQ(5, a.size());
+    EXPECT_EQ(7, a[4]);
+  }
+  element<size_t>::expect_no_instances();
+}
+
+template<typename V>
+void check_insert_middle() {
+  size_t const N = 100;
+  V a;
+  for (size_t i = 0; i != N; ++i)
+    a.push_back(2 * i);
+  a.reserve(4 * N);
+  for (size_t i = 0; i != N; ++i)
+    a.insert(a.begin() + 2 * i + 1, 2 * i + 1);
+  ASSERT_EQ(2 * N, a.size());
+  for (size_t i = 0; i != 2 * N; ++i)
+    EXPECT_EQ(i, a[i]);
+}
+
+TEST(correctness, insert_middle) {
+  check_insert_middle<vector<element<size_t> > >();
+  check_insert_middle<vector<size_t> >();
+  element<size_t>::expect_no_instances();
+}
+
+TEST(correctness, insert_n) {
+  {
+    vector<element<size_t> > a;
+    for (size_t i = 0; i != 10; ++i)
+      a.push_back(i);
+    // in place: longer and shorter than the tail
+    a.reserve(100);
+    a.insert(a.begin() + 8, 5, 42);
+    a.insert(a.begin() + 2, 3, a[9]);
+    // reallocating
+    a.insert(a.end(), 100, 1);
+    size_t expected[] = {0, 1, 42, 42, 42, 2, 3, 4, 5, 6, 7, 42, 42, 42, 42, 42, 8, 9};
+    ASSERT_EQ(118, a.size());
+    for (size_t i = 0; i != 18; ++i)
+      EXPECT_EQ(expected[i], a[i]);
+    for (size_t i = 18; i != a.size(); ++i)
+      EXPECT_EQ(1, a[i]);
+  }
+  element<size_t>::expect_no_instances();
+}
+
+TEST(correctness, insert_range) {
+  vector<vector<int> > a;
+  for (int i = 0; i != 10; ++i)
+    a.push_back(vector<int>(1, i));
+  std::list<vector<int> > l(3, vector<int>(2, -1));
+  a.insert(a.begin() + 5, l.begin(), l.end());
+  a.reserve(100);
+  a.insert(a.begin() + 1, l.begin(), l.end());
+  ASSERT_EQ(16, a.size());
+  EXPECT_EQ(0, a[0][0]);
+  for (size_t i = 1; i != 4; ++i)
+    EXPECT_EQ(2, a[i].size());
+  EXPECT_EQ(4, a[7][0]);
+  for (size_t i = 8; i != 11; ++i)
+    EXPECT_EQ(2, a[i].size());
+  EXPECT_EQ(9, a[15][0]);
+
+  std::istringstream in("1 2 3");
+  vector<int> b(2, 0);
+  b.insert(b.begin() + 1, std::istream_iterator<int>(in), std::istream_iterator<int>());
+  int expected[] = {0, 1, 2, 3, 0};
+  ASSERT_EQ(5, b.size());
+  for (size_t i = 0; i != 5; ++i)
+    EXPECT_EQ(expected[i], b[i]);
+}
+
+TEST(correctness, insert_throw) {
+  {
+    vector<element<size_t> > a;
+    a.reserve(100);
+    for (size_t i = 0; i != 10; ++i)
+      a.push_back(i);
+    element<size_t>::set_throw_countdown(15);
+    EXPECT_THROW(a.insert(a.begin() + 2, 10, 42), std::runtime_error);
+    element<size_t>::set_throw_countdown(0);
+    for (size_t i = 0; i != a.size(); ++i)
+      a[i] = a[i];
+  }
+  element<size_t>::expect_no_instances();
+}
+
+TEST(correctness, insert_realloc_throw) {
+  {
+    vector<element<size_t> > a;
+    for (size_t i = 0; i != 10; ++i)
+      a.push_back(i);
+    a.shrink_to_fit();
+    element<size_t>::set_throw_countdown(8);
+    EXPECT_THROW(a.insert(a.begin() + 5, 3, 42), std::runtime_error);
+    ASSERT_EQ(10, a.size());
+    for (size_t i = 0; i != 10; ++i)
+      EXPECT_EQ(i, a[i]);
+  }
+  element<size_t>::expect_no_instances();
+}
+
+TEST(correctness, erase_moves) {
+  vector<movable> a;
+  for (size_t i = 0; i != 100; ++i)
+    a.push_back(movable(i));
+  movable::reset();
+  a.erase(a.begin() + 10, a.begin() + 20);
+  a.erase(a.begin());
+  EXPECT_EQ(0, movable::copies);
+  ASSERT_EQ(89, a.size());
+  EXPECT_EQ(1, a[0].val);
+  EXPECT_EQ(20, a[9].val);
+}
+
+template<typename V>
+bool is_inline(V const& a) {
+  char const* p = reinterpret_cast<char const*>(a.data());
+  return p >= reinterpret_cast<char const*>(&a) && p < reinterpret_cast<char const*>(&a + 1);
+}
+
+TEST(correctness, small_layout) {
+  EXPECT_EQ(3 * sizeof(void*), sizeof(vector<int>));
+  small_vector<int, 8> a;
+  EXPECT_EQ(8, a.capacity());
+  EXPECT_TRUE(is_inline(a));
+}
+
+TEST(correctness, small_push_back) {
+  size_t const N = 100;
+  {
+    small_vector<element<size_t>, 8> a;
+    for (size_t i = 0; i != 8; ++i)
+      a.push_back(i);
+    EXPECT_TRUE(is_inline(a));
+    for (size_t i = 8; i != N; ++i)
+      a.push_back(a[i - 8]);
+    EXPECT_FALSE(is_inline(a));
+    for (size_t i = 0; i != N; ++i)
+      EXPECT_EQ(i % 8, a[i]);
+
+    while (a.size() > 5)
+      a.pop_back();
+    a.shrink_to_fit();
+    EXPECT_TRUE(is_inline(a));
+    EXPECT_EQ(8, a.capacity());
+    for (size_t i = 0; i != a.size(); ++i)
+      EXPECT_EQ(i, a[i]);
+  }
+  element<size_t>::expect_no_instances();
+}
+
+TEST(correctness, small_reallocation_throw) {
+  {
+    small_vector<element<size_t>, 8> a;
+    for (size_t i = 0; i != 8; ++i)
+      a.push_back(i);
+    element<size_t>::set_throw_countdown(7);
+    EXPECT_THROW(a.push_back(42), std::runtime_error);
+    EXPECT_TRUE(is_inline(a));
+    ASSERT_EQ(8, a.size());
+    for (size_t i = 0; i != 8; ++i)
+      EXPECT_EQ(i, a[i]);
+  }
+  element<size_t>::expect_no_instances();
+}
+
+TEST(correctness, small_copy_throw) {
+  {
+    typedef small_vector<element<size_t>, 8> vec_t;
+    vec_t a;
+    for (size_t i = 0; i != 20; ++i)
+      a.push_back(i);
+    element<size_t>::set_throw_countdown(7);
+    EXPECT_THROW({
+        vec_t b(a);
+    }, std::runtime_error);
+    element<size_t>::set_throw_countdown(0);
+
+    while (a.size() > 6)
+      a.pop_back();
+    vec_t c(a);
+    EXPECT_TRUE(is_inline(c));
+    EXPECT_EQ(8, c.capacity());
+  }
+  element<size_t>::expect_no_instances();
+}
+
+TEST(correctness, small_swap) {
+  {
+    small_vector<element<size_t>, 4> a, b, c;
+    for (size_t i = 0; i != 3; ++i)
+      a.push_back(i);
+    for (size_t i = 0; i != 10; ++i)
+      b.push_back(10 + i);
+    c.push_back(100);
+
+    a.swap(b);
+    EXPECT_FALSE(is_inline(a));
+    EXPECT_TRUE(is_inline(b));
+    ASSERT_EQ(10, a.size());
+    ASSERT_EQ(3, b.size());
+    EXPECT_EQ(19, a[9]);
+    EXPECT_EQ(2, b[2]);
+
+    b.swap(c);
+    ASSERT_EQ(1, b.size());
+    ASSERT_EQ(3, c.size());
+    EXPECT_EQ(100, b[0]);
+    EXPECT_EQ(1, c[1]);
+
+    small_vector<element<size_t>, 4> d(std::move(c));
+    EXPECT_TRUE(c.empty());
+    ASSERT_EQ(3, d.size());
+    EXPECT_EQ(2, d[2]);
+    d = std::move(a);
+    EXPECT_FALSE(is_inline(d));
+    EXPECT_EQ(10, d.size());
+  }
+  element<size_t>::expect_no_instances();
+}
+
+TEST(correctness, small_insert_erase) {
+  small_vector<std::string, 4> a(2, "a");
+  a.insert(a.begin() + 1, "b");
+  EXPECT_TRUE(is_inline(a));
+  a.insert(a.begin(), 3, "c");
+  EXPECT_FALSE(is_inline(a));
+  std::string expected[] = {"c", "c", "c", "a", "b", "a"};
+  ASSERT_EQ(6, a.size());
+  for (size_t i = 0; i != 6; ++i)
+    EXPECT_EQ(expected[i], a[i]);
+  a.erase(a.begin(), a.begin() + 3);
+  a.shrink_to_fit();
+  EXPECT_TRUE(is_inline(a));
+  EXPECT_EQ("b", a[1]);
+}
+
+// stateful allocator, checks that blocks are freed by an equal allocator with their size
+template<typename T, bool Propagate>
+struct tracking_allocator {
+  typedef T value_type;
+  typedef std::integral_constant<bool, Propagate> propagate_on_container_copy_assignment;
+  typedef std::integral_constant<bool, Propagate> propagate_on_container_move_assignment;
+  typedef std::integral_constant<bool, Propagate> propagate_on_container_swap;
+
+  template<typename U>
+  struct rebind {
+    typedef tracking_allocator<U, Propagate> other;
+  };
+
+  explicit tracking_allocator(int id = 0) : id(id) {}
+
+  template<typename U>
+  tracking_allocator(tracking_allocator<U, Propagate> const& rhs) : id(rhs.id) {}
+
+  T* allocate(size_t n) {
+    T* p = static_cast<T*>(operator new(n * sizeof(T)));
+    blocks()[p] = std::make_pair(id, n);
+    return p;
+  }
+
+  void deallocate(T* p, size_t n) {
+    auto it = blocks().find(p);
+    if (it == blocks().end()) {
+      ADD_FAILURE() << "deallocating a block that was not allocated";
+      return;
+    }
+    EXPECT_EQ(id, it->second.first);
+    EXPECT_EQ(n, it->second.second);
+    blocks().erase(it);
+    operator delete(p);
+  }
+
+  template<typename U, typename... Args>
+  void construct(U* p, Args&&... args) {
+    ++constructs();
+    new(p) U(std::forward<Args>(args)...);
+  }
+
+  static std::map<void*, std::pair<int, size_t> >& blocks() {
+    static std::map<void*, std::pair<int, size_t> > blocks;
+    return blocks;
+  }
+
+  static size_t& constructs() {
+    static size_t constructs = 0;
+    return constructs;
+  }
+
+  static size_t allocated(int id) {
+    size_t res = 0;
+    for (auto const& b : blocks())
+      res += b.second.first == id;
+    return res;
+  }
+
+  friend bool operator==(tracking_allocator const& a, tracking_allocator const& b) {
+    return a.id == b.id;
+  }
+
+  friend bool operator!=(tracking_allocator const& a, tracking_allocator const& b) {
+    return a.id != b.id;
+  }
+
+  int id;
+};
+
+TEST(correctness, allocator_default) {
+  bool same = std::is_same<std::allocator<int>, vector<int>::allocator_type>::value;
+  EXPECT_TRUE(same);
+  EXPECT_TRUE(is_trivially_relocatable<vector<std::string> >::value);
+  EXPECT_TRUE(allocator_is_plain<std::allocator<std::string> >::value);
+  EXPECT_FALSE((allocator_is_plain<tracking_allocator<int, false> >::value));
+}
+
+TEST(correctness, allocator_stateful) {
+  typedef tracking_allocator<int, false> alloc_t;
+  {
+    vector<int, alloc_t> a(alloc_t(1));
+    for (int i = 0; i != 1000; ++i)
+      a.push_back(i);
+    a.insert(a.begin() + 10, 100, 5);
+    a.shrink_to_fit();
+    EXPECT_EQ(1, alloc_t::allocated(1));
+    EXPECT_EQ(1, a.get_allocator().id);
+
+    vector<int, alloc_t> b(a);
+    EXPECT_EQ(1, b.get_allocator().id);
+    vector<int, alloc_t> c(a, alloc_t(2));
+    EXPECT_EQ(1, alloc_t::allocated(2));
+    for (size_t i = 0; i != a.size(); ++i)
+      EXPECT_EQ(a[i], c[i]);
+  }
+  EXPECT_TRUE(alloc_t::blocks().empty());
+}
+
+TEST(correctness, allocator_construct) {
+  typedef tracking_allocator<int, false> alloc_t;
+  vector<int, alloc_t> a;
+  alloc_t::constructs() = 0;
+  for (int i = 0; i != 100; ++i)
+    a.push_back(i);
+  // elements are not relocated bitwise, the allocator constructs them on every reallocation
+  EXPECT_LT(100, alloc_t::constructs());
+}
+
+TEST(correctness, allocator_no_propagation) {
+  typedef tracking_allocator<std::string, false> alloc_t;
+  {
+    vector<std::string, alloc_t> a(3, "a", alloc_t(1)), b(5, "b", alloc_t(2));
+    a = b;
+    EXPECT_EQ(1, a.get_allocator().id);
+    EXPECT_EQ(5, a.size());
+
+    // elements are moved into a buffer of the other allocator
+    std::string const* old = b.data();
+    a = std::move(b);
+    EXPECT_EQ(1, a.get_allocator().id);
+    EXPECT_NE(old, a.data());
+    EXPECT_EQ("b", a[4]);
+
+    vector<std::string, alloc_t> c(std::move(a), alloc_t(3));
+    EXPECT_EQ(3, c.get_allocator().id);
+    EXPECT_EQ(5, c.size());
+    EXPECT_EQ(1, alloc_t::allocated(3));
+  }
+  EXPECT_TRUE(alloc_t::blocks().empty());
+}
+
+TEST(correctness, allocator_propagation) {
+  typedef tracking_allocator<std::string, true> alloc_t;
+  {
+    vector<std::string, alloc_t> a(3, "a", alloc_t(1)), b(5, "b", alloc_t(2));
+    a = b;
+    EXPECT_EQ(2, a.get_allocator().id);
+    EXPECT_EQ(0, alloc_t::allocated(1));
+
+    vector<std::string, alloc_t> c(2, "c", alloc_t(3));
+    std::string const* old = c.data();
+    a = std::move(c);
+    EXPECT_EQ(3, a.get_allocator().id);
+    EXPECT_EQ(old, a.data());
+
+    a.swap(b);
+    EXPECT_EQ(2, a.get_allocator().id);
+    EXPECT_EQ(3, b.get_allocator().id);
+    EXPECT_EQ("c", b[1]);
+  }
+  EXPECT_TRUE(alloc_t::blocks().empty());
+}
+
+TEST(correctness, allocator_small) {
+  typedef tracking_allocator<int, false> alloc_t;
+  {
+    small_vector<int, 8, alloc_t> a(alloc_t(1));
+    for (int i = 0; i != 8; ++i)
+      a.push_back(i);
+    EXPECT_EQ(0, alloc_t::allocated(1));
+    a.push_back(8);
+    EXPECT_EQ(1, alloc_t::allocated(1));
+    a.pop_back();
+    a.shrink_to_fit();
+    EXPECT_EQ(0, alloc_t::allocated(1));
+  }
+  EXPECT_TRUE(alloc_t::blocks().empty());
+}
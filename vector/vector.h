@@ -5,16 +5,117 @@
 
 #include <cstring>
 #include <algorithm>
+#include <utility>
+#include <type_traits>
+#include <new>
+#include <iterator>
+#include <memory>
 
+// T may be moved to other memory by copying its bytes (the source is then not destroyed),
+// may be specialized for types without self-references
 template<typename T>
-struct vector
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+// allocator constructs and destroys elements by placement new and destructor call
+// (as std::allocator does), so elements may be relocated bitwise bypassing it
+template<typename Allocator>
+struct allocator_is_plain
+{
+private:
+  typedef typename Allocator::value_type T;
+
+  template<typename A>
+    static auto constructs(int)
+      -> decltype(std::declval<A &>().construct(std::declval<T *>(), std::declval<T &&>()), std::true_type());
+  template<typename A>
+    static std::false_type constructs(...);
+  template<typename A>
+    static auto destroys(int) -> decltype(std::declval<A &>().destroy(std::declval<T *>()), std::true_type());
+  template<typename A>
+    static std::false_type destroys(...);
+
+public:
+  static constexpr bool value =
+    !decltype(constructs<Allocator>(0))::value && !decltype(destroys<Allocator>(0))::value;
+};
+
+template<typename T>
+struct allocator_is_plain<std::allocator<T>> : std::true_type {};
+
+// places for N elements inside the small vector, none for N == 0
+template<typename T, size_t N>
+struct vector_inline_storage
+{
+  T * inline_data()
+  {
+    return reinterpret_cast<T *>(places_);
+  }
+
+private:
+  typename std::aligned_storage<sizeof(T), alignof(T)>::type places_[N];
+};
+
+template<typename T>
+struct vector_inline_storage<T, 0>
 {
+  T * inline_data()
+  {
+    return nullptr;
+  }
+};
+
+// elements are stored inline until there are more than N of them (small vector),
+// all algorithms are shared with plain vector (N == 0);
+// a stateless allocator takes no space (empty base)
+template<typename T, typename Allocator = std::allocator<T>, size_t N = 0>
+struct vector : private vector_inline_storage<T, N>, private Allocator
+{
+private:
+  using alloc_traits = std::allocator_traits<Allocator>;
+  static_assert(std::is_same<typename alloc_traits::value_type, T>::value, "allocator must allocate T");
+  static_assert(std::is_same<typename alloc_traits::pointer, T *>::value, "fancy pointers are not supported");
+
+  // elements are relocated bitwise if possible, moved if that cannot throw, copied otherwise
+  using relocate_bitwise =
+    std::integral_constant<bool, is_trivially_relocatable<T>::value && allocator_is_plain<Allocator>::value>;
+  // moving and swapping relocate inline elements
+  static constexpr bool nothrow_steal =
+    N == 0 || relocate_bitwise::value || std::is_nothrow_move_constructible<T>::value;
+  // buffers are exchanged only with allocators that compare equal
+  static constexpr bool nothrow_move_assign =
+    nothrow_steal && (alloc_traits::propagate_on_container_move_assignment::value ||
+                      std::is_empty<Allocator>::value);
+
+  // distinguishes iterator pairs from (count, value) arguments
+  template<typename It>
+    using if_iterator = typename std::enable_if<!std::is_integral<It>::value>::type;
+
+public:
+  typedef T value_type;
+  typedef Allocator allocator_type;
   typedef T * iterator;
   typedef const T * const_iterator;
 
   vector() = default;                     // O(1) nothrow
+  explicit vector(const Allocator &alloc); // O(1) nothrow
+  explicit vector(size_t n, const Allocator &alloc = Allocator()); // O(N) strong
+  vector(size_t n, const T &val, const Allocator &alloc = Allocator()); // O(N) strong
+  template<typename InputIt, typename = if_iterator<InputIt>>
+    vector(InputIt first, InputIt last, const Allocator &alloc = Allocator()); // O(N) strong
   vector(const vector &);                 // O(N) strong
+  vector(const vector &, const Allocator &alloc); // O(N) strong
+  vector(vector &&) noexcept(nothrow_steal); // O(1) nothrow, O(N) if inline
+  // elements are moved one by one if allocators are not equal
+  vector(vector &&, const Allocator &alloc); // O(1), O(N) if inline or not equal
+  // allocators propagate as allocator_traits tell
   vector & operator=(const vector &other); // O(N) strong
+  vector & operator=(vector &&other) noexcept(nothrow_move_assign); // O(1) nothrow, O(N) if inline
+
+  Allocator get_allocator() const;        // O(1) nothrow
+
+  void assign(size_t n, const T &val);    // O(N) strong
+  template<typename InputIt, typename = if_iterator<InputIt>>
+    void assign(InputIt first, InputIt last); // O(N) strong
 
   ~vector();                              // O(N) nothrow
 
@@ -31,6 +132,9 @@ struct vector
   T & back();                             // O(1) nothrow
   const T & back() const;                 // O(1) nothrow
   void push_back(const T &);              // O(1)* strong
+  void push_back(T &&);                   // O(1)* strong
+  template<typename... Args>
+    void emplace_back(Args &&... args);   // O(1)* strong
   void pop_back();                        // O(1) nothrow
 
   bool empty() const;                     // O(1) nothrow
@@ -41,7 +145,8 @@ struct vector
 
   void clear();                           // O(N) nothrow
 
-  void swap(vector &);                    // O(1) nothrow
+  // allocators must be equal unless they propagate on swap
+  void swap(vector &) noexcept(nothrow_steal); // O(1) nothrow, O(N) if inline
 
   iterator begin();                       // O(1) nothrow
   iterator end();                         // O(1) nothrow
@@ -49,46 +154,99 @@ struct vector
   const_iterator begin() const;           // O(1) nothrow
   const_iterator end() const;             // O(1) nothrow
 
+  // all inserts are strong if they reallocate or T is trivially relocatable
   iterator insert(const_iterator pos, const T &); // O(N) weak
+  iterator insert(const_iterator pos, T &&); // O(N) weak
+  iterator insert(const_iterator pos, size_t n, const T &val); // O(N + n) weak
+  template<typename InputIt, typename = if_iterator<InputIt>>
+    iterator insert(const_iterator pos, InputIt first, InputIt last); // O(N + n) weak
   iterator erase(const_iterator pos);     // O(N) weak
   iterator erase(const_iterator first, const_iterator last); // O(N) weak
 
 private:
+  Allocator & alloc_ref();
+  const Allocator & alloc_ref() const;
+  T * allocate(size_t capacity);
+  // inline places are not freed
+  void deallocate(T *data, size_t capacity);
+  bool is_small();
+  // takes elements of other, this must be empty and own no heap buffer, allocators must be equal
+  void steal(vector &other) noexcept(nothrow_steal);
+  void swap_storage(vector &other) noexcept(nothrow_steal);
+  // swaps allocators regardless of propagation (for assignments)
+  void swap_all(vector &other) noexcept(nothrow_steal);
   void ensure_capacity(size_t new_capacity);
   void new_buffer(size_t new_capacity);
+  // makes a gap of n uninitialized places at pos and calls construct(data_ + pos) to fill it,
+  // construct destroys what it has constructed if it throws
+  template<typename Construct>
+    void insert_n(size_t pos, size_t n, Construct construct);
+  // new elements are constructed before old ones are relocated (so that they may be the source)
+  template<typename Construct>
+    void insert_realloc(size_t pos, size_t n, Construct construct);
+  template<typename Construct>
+    void insert_in_place(size_t pos, size_t n, Construct construct, std::true_type);
+  template<typename Construct>
+    void insert_in_place(size_t pos, size_t n, Construct construct, std::false_type);
+  template<typename InputIt>
+    iterator insert_range(size_t pos, InputIt first, InputIt last, std::input_iterator_tag);
+  template<typename ForwardIt>
+    iterator insert_range(size_t pos, ForwardIt first, ForwardIt last, std::forward_iterator_tag);
+  void erase_n(size_t first, size_t last, std::true_type);
+  void erase_n(size_t first, size_t last, std::false_type);
 
 private:
-  T *data_ = nullptr;
+  T *data_ = this->inline_data();
   size_t size_ = 0;
-  size_t capacity_ = 0;
-
-  static void destroy_at(T *data, size_t at);
-  static void destroy_n(T *data, size_t begin, size_t end);
-  static void copy_construct_at(T *data, size_t at, const T &other);
-  static void copy_construct_n(T *data, size_t begin, size_t end, T *other, size_t other_begin);
+  size_t capacity_ = N;
+
+  // elements are constructed and destroyed by the allocator
+  void destroy_at(T *data, size_t at);
+  void destroy_n(T *data, size_t begin, size_t end);
+  void copy_construct_at(T *data, size_t at, const T &other);
+  void copy_construct_n(T *data, size_t begin, size_t end, T *other, size_t other_begin);
+  void value_construct_n(T *data, size_t n);
+  void fill_construct_n(T *data, size_t n, const T &val);
+  template<typename It>
+    void copy_construct_range(T *data, size_t n, It first);
+
+  // constructs data[0..n) from other[0..n), others are to be destroyed unless relocated bitwise,
+  // strong (others are not changed if it throws)
+  void relocate_n(T *data, T *other, size_t n, std::true_type);
+  void relocate_n(T *data, T *other, size_t n, std::false_type);
+  void destroy_relocated_n(T *data, size_t n, std::true_type);
+  void destroy_relocated_n(T *data, size_t n, std::false_type);
 };
 
-template<typename T>
-void vector<T>::destroy_at(T *data, size_t at)
+template<typename T, size_t N, typename Allocator = std::allocator<T>>
+using small_vector = vector<T, Allocator, N>;
+
+// only pointers (and the allocator) are stored
+template<typename T, typename Allocator>
+struct is_trivially_relocatable<vector<T, Allocator, 0>>
+  : std::integral_constant<bool, std::is_empty<Allocator>::value || is_trivially_relocatable<Allocator>::value> {};
+
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::destroy_at(T *data, size_t at)
 {
-  data[at].~T();
+  alloc_traits::destroy(alloc_ref(), data + at);
 }
 
-template<typename T>
-void vector<T>::destroy_n(T *data, size_t begin, size_t end)
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::destroy_n(T *data, size_t begin, size_t end)
 {
   for (size_t i = end; i > begin; i--)
     destroy_at(data, i - 1);
 }
 
-template<typename T>
-void vector<T>::copy_construct_at(T *data, size_t at, const T &other)
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::copy_construct_at(T *data, size_t at, const T &other)
 {
-  new(data + at) T(other);
+  alloc_traits::construct(alloc_ref(), data + at, other);
 }
 
-template<typename T>
-void vector<T>::copy_construct_n(T *data, size_t begin, size_t end, T *other, size_t other_begin)
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::copy_construct_n(T *data, size_t begin, size_t end, T *other, size_t other_begin)
 {
   size_t i = 0;
 
@@ -104,42 +262,318 @@ void vector<T>::copy_construct_n(T *data, size_t begin, size_t end, T *other, si
   }
 }
 
-template<typename T>
-void vector<T>::new_buffer(size_t new_capacity)
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::value_construct_n(T *data, size_t n)
+{
+  size_t i = 0;
+
+  try
+  {
+    for (i = 0; i < n; i++)
+      alloc_traits::construct(alloc_ref(), data + i);
+  }
+  catch (...)
+  {
+    destroy_n(data, 0, i);
+    throw;
+  }
+}
+
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::fill_construct_n(T *data, size_t n, const T &val)
+{
+  size_t i = 0;
+
+  try
+  {
+    for (i = 0; i < n; i++)
+      alloc_traits::construct(alloc_ref(), data + i, val);
+  }
+  catch (...)
+  {
+    destroy_n(data, 0, i);
+    throw;
+  }
+}
+
+template<typename T, typename Allocator, size_t N>
+template<typename It>
+void vector<T, Allocator, N>::copy_construct_range(T *data, size_t n, It first)
+{
+  size_t i = 0;
+
+  try
+  {
+    for (i = 0; i < n; i++, ++first)
+      alloc_traits::construct(alloc_ref(), data + i, *first);
+  }
+  catch (...)
+  {
+    destroy_n(data, 0, i);
+    throw;
+  }
+}
+
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::relocate_n(T *data, T *other, size_t n, std::true_type)
+{
+  if (n != 0)
+    std::memcpy(static_cast<void *>(data), static_cast<const void *>(other), n * sizeof(T));
+}
+
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::relocate_n(T *data, T *other, size_t n, std::false_type)
+{
+  size_t i = 0;
+
+  try
+  {
+    // moves do not throw, so a throwing copy leaves others unchanged
+    for (i = 0; i < n; i++)
+      alloc_traits::construct(alloc_ref(), data + i, std::move_if_noexcept(other[i]));
+  }
+  catch (...)
+  {
+    destroy_n(data, 0, i);
+    throw;
+  }
+}
+
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::destroy_relocated_n(T *, size_t, std::true_type)
+{
+}
+
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::destroy_relocated_n(T *data, size_t n, std::false_type)
+{
+  destroy_n(data, 0, n);
+}
+
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::new_buffer(size_t new_capacity)
 {
   new_capacity = std::max(new_capacity, size_);
   T *new_data;
-  if (new_capacity == 0)
-    new_data = nullptr;
+  if (new_capacity <= N)
+  {
+    // buffer is inline (or empty)
+    new_capacity = N;
+    new_data = this->inline_data();
+    if (new_data == data_)
+      return;
+  }
   else
+    new_data = allocate(new_capacity);
+  try
   {
-    new_data = static_cast<T *>(operator new(new_capacity * sizeof(T)));
+    relocate_n(new_data, data_, size_, relocate_bitwise());
+  }
+  catch (...)
+  {
+    deallocate(new_data, new_capacity);
+    throw;
+  }
+  destroy_relocated_n(data_, size_, relocate_bitwise());
+  deallocate(data_, capacity_);
+  data_ = new_data;
+  capacity_ = new_capacity;
+}
+
+template<typename T, typename Allocator, size_t N>
+template<typename Construct>
+void vector<T, Allocator, N>::insert_n(size_t pos, size_t n, Construct construct)
+{
+  if (n == 0)
+    return;
+  if (capacity_ - size_ >= n)
+    insert_in_place(pos, n, construct, relocate_bitwise());
+  else
+    insert_realloc(pos, n, construct);
+}
+
+template<typename T, typename Allocator, size_t N>
+template<typename Construct>
+void vector<T, Allocator, N>::insert_realloc(size_t pos, size_t n, Construct construct)
+{
+  size_t new_capacity = std::max(capacity_ * 3 / 2, size_ + n);
+  T *new_data = allocate(new_capacity);
+  try
+  {
+    construct(new_data + pos);
+  }
+  catch (...)
+  {
+    deallocate(new_data, new_capacity);
+    throw;
+  }
+  try
+  {
+    relocate_n(new_data, data_, pos, relocate_bitwise());
     try
     {
-      copy_construct_n(new_data, 0, size_, data_, 0);
+      relocate_n(new_data + pos + n, data_ + pos, size_ - pos, relocate_bitwise());
     }
     catch (...)
     {
-      operator delete(new_data);
+      destroy_n(new_data, 0, pos);
       throw;
     }
   }
-  destroy_n(data_, 0, size_);
-  operator delete(data_);
+  catch (...)
+  {
+    destroy_n(new_data, pos, pos + n);
+    deallocate(new_data, new_capacity);
+    throw;
+  }
+  destroy_relocated_n(data_, size_, relocate_bitwise());
+  deallocate(data_, capacity_);
   data_ = new_data;
   capacity_ = new_capacity;
+  size_ += n;
 }
 
-template<typename T>
-void vector<T>::ensure_capacity(size_t new_capacity)
+template<typename T, typename Allocator, size_t N>
+template<typename Construct>
+void vector<T, Allocator, N>::insert_in_place(size_t pos, size_t n, Construct construct, std::true_type)
+{
+  void *gap = data_ + pos, *moved = data_ + pos + n;
+  size_t bytes = (size_ - pos) * sizeof(T);
+  std::memmove(moved, gap, bytes);
+  try
+  {
+    construct(data_ + pos);
+  }
+  catch (...)
+  {
+    std::memmove(gap, moved, bytes);
+    throw;
+  }
+  size_ += n;
+}
+
+template<typename T, typename Allocator, size_t N>
+template<typename Construct>
+void vector<T, Allocator, N>::insert_in_place(size_t pos, size_t n, Construct construct, std::false_type)
+{
+  size_t old_size = size_, moved = std::min(n, old_size - pos);
+
+  // the last elements go to uninitialized places, the rest are shifted by assignment
+  relocate_n(data_ + old_size + n - moved, data_ + old_size - moved, moved, std::false_type());
+  try
+  {
+    std::move_backward(data_ + pos, data_ + old_size - moved, data_ + old_size);
+  }
+  catch (...)
+  {
+    destroy_n(data_, old_size + n - moved, old_size + n);
+    throw;
+  }
+  // moved-from elements in the gap are replaced
+  destroy_n(data_, pos, pos + moved);
+  try
+  {
+    construct(data_ + pos);
+  }
+  catch (...)
+  {
+    // the gap cannot be filled back, elements after it are dropped
+    destroy_n(data_, pos + n, old_size + n);
+    size_ = pos;
+    throw;
+  }
+  size_ = old_size + n;
+}
+
+template<typename T, typename Allocator, size_t N>
+Allocator & vector<T, Allocator, N>::alloc_ref()
+{
+  return *this;
+}
+
+template<typename T, typename Allocator, size_t N>
+const Allocator & vector<T, Allocator, N>::alloc_ref() const
+{
+  return *this;
+}
+
+template<typename T, typename Allocator, size_t N>
+T * vector<T, Allocator, N>::allocate(size_t capacity)
+{
+  return alloc_traits::allocate(alloc_ref(), capacity);
+}
+
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::deallocate(T *data, size_t capacity)
+{
+  if (data != this->inline_data())
+    alloc_traits::deallocate(alloc_ref(), data, capacity);
+}
+
+template<typename T, typename Allocator, size_t N>
+bool vector<T, Allocator, N>::is_small()
+{
+  return N != 0 && data_ == this->inline_data();
+}
+
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::steal(vector &other) noexcept(nothrow_steal)
+{
+  if (other.is_small())
+  {
+    relocate_n(data_, other.data_, other.size_, relocate_bitwise());
+    destroy_relocated_n(other.data_, other.size_, relocate_bitwise());
+    std::swap(size_, other.size_);
+    return;
+  }
+  data_ = other.data_;
+  size_ = other.size_;
+  capacity_ = other.capacity_;
+  other.data_ = other.inline_data();
+  other.size_ = 0;
+  other.capacity_ = N;
+}
+
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::ensure_capacity(size_t new_capacity)
 {
   if (capacity_ >= new_capacity)
     return;
   new_buffer(std::max(capacity_ * 3 / 2, new_capacity));
 }
 
-template<typename T>
-vector<T>::vector(const vector &other)
+template<typename T, typename Allocator, size_t N>
+vector<T, Allocator, N>::vector(const Allocator &alloc) : Allocator(alloc)
+{
+}
+
+template<typename T, typename Allocator, size_t N>
+vector<T, Allocator, N>::vector(size_t n, const Allocator &alloc) : Allocator(alloc)
+{
+  insert_n(0, n, [this, n] (T *data) { value_construct_n(data, n); });
+}
+
+template<typename T, typename Allocator, size_t N>
+vector<T, Allocator, N>::vector(size_t n, const T &val, const Allocator &alloc) : Allocator(alloc)
+{
+  insert(begin(), n, val);
+}
+
+template<typename T, typename Allocator, size_t N>
+template<typename InputIt, typename>
+vector<T, Allocator, N>::vector(InputIt first, InputIt last, const Allocator &alloc) : Allocator(alloc)
+{
+  insert(begin(), first, last);
+}
+
+template<typename T, typename Allocator, size_t N>
+vector<T, Allocator, N>::vector(const vector &other)
+  : vector(other, alloc_traits::select_on_container_copy_construction(other.alloc_ref()))
+{
+}
+
+template<typename T, typename Allocator, size_t N>
+vector<T, Allocator, N>::vector(const vector &other, const Allocator &alloc) : Allocator(alloc)
 {
   new_buffer(other.size_);
   try
@@ -148,197 +582,340 @@ vector<T>::vector(const vector &other)
   }
   catch (...)
   {
-    operator delete(data_);
-    data_ = nullptr;
-    size_ = capacity_ = 0;
+    deallocate(data_, capacity_);
+    data_ = this->inline_data();
+    capacity_ = N;
     throw;
   }
   size_ = other.size_;
 }
 
-template<typename T>
-vector<T> & vector<T>::operator=(const vector &other) {
+template<typename T, typename Allocator, size_t N>
+vector<T, Allocator, N>::vector(vector &&other) noexcept(nothrow_steal) : Allocator(other.alloc_ref())
+{
+  steal(other);
+}
+
+template<typename T, typename Allocator, size_t N>
+vector<T, Allocator, N>::vector(vector &&other, const Allocator &alloc) : Allocator(alloc)
+{
+  if (alloc_ref() == other.alloc_ref())
+    steal(other);
+  else
+    insert_range(0, std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()),
+                 std::random_access_iterator_tag());
+}
+
+template<typename T, typename Allocator, size_t N>
+vector<T, Allocator, N> & vector<T, Allocator, N>::operator=(const vector &other) {
+  // the copy is made with the allocator the result should have
   if (this != &other)
-    vector(other).swap(*this);
+    vector(other, alloc_traits::propagate_on_container_copy_assignment::value ? other.alloc_ref() : alloc_ref())
+      .swap_all(*this);
   return *this;
 }
 
-template<typename T>
-vector<T>::~vector()
+template<typename T, typename Allocator, size_t N>
+vector<T, Allocator, N> & vector<T, Allocator, N>::operator=(vector &&other) noexcept(nothrow_move_assign)
+{
+  if (this != &other)
+    vector(std::move(other),
+           alloc_traits::propagate_on_container_move_assignment::value ? other.alloc_ref() : alloc_ref())
+      .swap_all(*this);
+  return *this;
+}
+
+template<typename T, typename Allocator, size_t N>
+Allocator vector<T, Allocator, N>::get_allocator() const
+{
+  return alloc_ref();
+}
+
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::assign(size_t n, const T &val)
+{
+  vector(n, val, alloc_ref()).swap(*this);
+}
+
+template<typename T, typename Allocator, size_t N>
+template<typename InputIt, typename>
+void vector<T, Allocator, N>::assign(InputIt first, InputIt last)
+{
+  vector(first, last, alloc_ref()).swap(*this);
+}
+
+template<typename T, typename Allocator, size_t N>
+vector<T, Allocator, N>::~vector()
 {
   clear();
-  operator delete(data_);
+  deallocate(data_, capacity_);
 }
 
-template<typename T>
-T & vector<T>::operator[](size_t i)
+template<typename T, typename Allocator, size_t N>
+T & vector<T, Allocator, N>::operator[](size_t i)
 {
   return data_[i];
 }
 
-template<typename T>
-const T & vector<T>::operator[](size_t i) const
+template<typename T, typename Allocator, size_t N>
+const T & vector<T, Allocator, N>::operator[](size_t i) const
 {
   return data_[i];
 }
 
-template<typename T>
-T * vector<T>::data()
+template<typename T, typename Allocator, size_t N>
+T * vector<T, Allocator, N>::data()
 {
   return data_;
 }
 
-template<typename T>
-const T * vector<T>::data() const
+template<typename T, typename Allocator, size_t N>
+const T * vector<T, Allocator, N>::data() const
 {
   return data_;
 }
 
-template<typename T>
-size_t vector<T>::size() const
+template<typename T, typename Allocator, size_t N>
+size_t vector<T, Allocator, N>::size() const
 {
   return size_;
 }
 
-template<typename T>
-T & vector<T>::front()
+template<typename T, typename Allocator, size_t N>
+T & vector<T, Allocator, N>::front()
 {
   return data_[0];
 }
 
-template<typename T>
-const T & vector<T>::front() const
+template<typename T, typename Allocator, size_t N>
+const T & vector<T, Allocator, N>::front() const
 {
   return data_[0];
 }
 
-template<typename T>
-T & vector<T>::back()
+template<typename T, typename Allocator, size_t N>
+T & vector<T, Allocator, N>::back()
 {
   return data_[size_ - 1];
 }
 
-template<typename T>
-const T & vector<T>::back() const
+template<typename T, typename Allocator, size_t N>
+const T & vector<T, Allocator, N>::back() const
 {
   return data_[size_ - 1];
 }
 
-template<typename T>
-void vector<T>::push_back(const T &other)
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::push_back(const T &other)
+{
+  emplace_back(other);
+}
+
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::push_back(T &&other)
+{
+  emplace_back(std::move(other));
+}
+
+template<typename T, typename Allocator, size_t N>
+template<typename... Args>
+void vector<T, Allocator, N>::emplace_back(Args &&... args)
 {
   if (size_ < capacity_)
   {
-    copy_construct_at(data_, size_, other);
+    alloc_traits::construct(alloc_ref(), data_ + size_, std::forward<Args>(args)...);
     ++size_;
   }
   else
-  {
-    T buf = other;
-    ensure_capacity(size_ + 1);
-    copy_construct_at(data_, size_, buf);
-    ++size_;
-  }
+    insert_realloc(size_, 1, [&] (T *data) { alloc_traits::construct(alloc_ref(), data, std::forward<Args>(args)...); });
 }
 
-template<typename T>
-void vector<T>::pop_back()
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::pop_back()
 {
   destroy_at(data_, --size_);
 }
 
-template<typename T>
-bool vector<T>::empty() const
+template<typename T, typename Allocator, size_t N>
+bool vector<T, Allocator, N>::empty() const
 {
   return size_ == 0;
 }
 
-template<typename T>
-size_t vector<T>::capacity() const
+template<typename T, typename Allocator, size_t N>
+size_t vector<T, Allocator, N>::capacity() const
 {
   return capacity_;
 }
 
-template<typename T>
-void vector<T>::reserve(size_t new_capacity)
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::reserve(size_t new_capacity)
 {
   ensure_capacity(new_capacity);
 }
 
-template<typename T>
-void vector<T>::shrink_to_fit()
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::shrink_to_fit()
 {
   if (capacity_ != size_)
     new_buffer(size_);
 }
 
-template<typename T>
-void vector<T>::clear()
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::clear()
 {
   destroy_n(data_, 0, size_);
   size_ = 0;
 }
 
-template<typename T>
-void vector<T>::swap(vector &other)
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::swap(vector &other) noexcept(nothrow_steal)
 {
-  std::swap(data_, other.data_);
-  std::swap(size_, other.size_);
-  std::swap(capacity_, other.capacity_);
+  if (alloc_traits::propagate_on_container_swap::value)
+  {
+    using std::swap;
+    swap(alloc_ref(), other.alloc_ref());
+  }
+  swap_storage(other);
 }
 
-template<typename T>
-typename vector<T>::iterator vector<T>::begin()
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::swap_all(vector &other) noexcept(nothrow_steal)
+{
+  using std::swap;
+  swap(alloc_ref(), other.alloc_ref());
+  swap_storage(other);
+}
+
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::swap_storage(vector &other) noexcept(nothrow_steal)
+{
+  if (!is_small() && !other.is_small())
+  {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(capacity_, other.capacity_);
+    return;
+  }
+  // inline places cannot be exchanged, their elements are relocated
+  vector tmp(std::move(other));
+  other.steal(*this);
+  steal(tmp);
+}
+
+template<typename T, typename Allocator, size_t N>
+typename vector<T, Allocator, N>::iterator vector<T, Allocator, N>::begin()
 {
   return data_;
 }
 
-template<typename T>
-typename vector<T>::iterator vector<T>::end()
+template<typename T, typename Allocator, size_t N>
+typename vector<T, Allocator, N>::iterator vector<T, Allocator, N>::end()
 {
   return data_ + size_;
 }
 
-template<typename T>
-typename vector<T>::const_iterator vector<T>::begin() const
+template<typename T, typename Allocator, size_t N>
+typename vector<T, Allocator, N>::const_iterator vector<T, Allocator, N>::begin() const
 {
   return data_;
 }
 
-template<typename T>
-typename vector<T>::const_iterator vector<T>::end() const
+template<typename T, typename Allocator, size_t N>
+typename vector<T, Allocator, N>::const_iterator vector<T, Allocator, N>::end() const
 {
   return data_ + size_;
 }
 
-template<typename T>
-typename vector<T>::iterator vector<T>::insert(const_iterator pos, const T &val)
+template<typename T, typename Allocator, size_t N>
+typename vector<T, Allocator, N>::iterator vector<T, Allocator, N>::insert(const_iterator pos, const T &val)
+{
+  return insert(pos, 1, val);
+}
+
+template<typename T, typename Allocator, size_t N>
+typename vector<T, Allocator, N>::iterator vector<T, Allocator, N>::insert(const_iterator pos, T &&val)
+{
+  size_t at = static_cast<size_t>(pos - begin());
+  insert_n(at, 1, [this, &val] (T *data) { alloc_traits::construct(alloc_ref(), data, std::move(val)); });
+  return begin() + at;
+}
+
+template<typename T, typename Allocator, size_t N>
+typename vector<T, Allocator, N>::iterator vector<T, Allocator, N>::insert(const_iterator pos, size_t n, const T &val)
 {
-  size_t before = static_cast<size_t>(pos - begin());
+  size_t at = static_cast<size_t>(pos - begin());
+  // the value would be shifted by the insertion
+  if (&val >= data_ && &val < data_ + size_)
+  {
+    T copy(val);
+    return insert(pos, n, copy);
+  }
+  insert_n(at, n, [this, n, &val] (T *data) { fill_construct_n(data, n, val); });
+  return begin() + at;
+}
 
-  push_back(val);
-  for (size_t i = size_ - 1; i > before; i--)
-    std::swap(data_[i - 1], data_[i]);
+template<typename T, typename Allocator, size_t N>
+template<typename InputIt, typename>
+typename vector<T, Allocator, N>::iterator vector<T, Allocator, N>::insert(const_iterator pos, InputIt first, InputIt last)
+{
+  return insert_range(static_cast<size_t>(pos - begin()), first, last,
+                      typename std::iterator_traits<InputIt>::iterator_category());
+}
 
-  return begin() + before;
+template<typename T, typename Allocator, size_t N>
+template<typename InputIt>
+typename vector<T, Allocator, N>::iterator vector<T, Allocator, N>::insert_range(size_t pos, InputIt first, InputIt last,
+                                                     std::input_iterator_tag)
+{
+  // the length is unknown, elements are gathered first
+  vector buf(alloc_ref());
+  for (; first != last; ++first)
+    buf.emplace_back(*first);
+  return insert_range(pos, std::make_move_iterator(buf.begin()), std::make_move_iterator(buf.end()),
+                      std::random_access_iterator_tag());
 }
 
-template<typename T>
-typename vector<T>::iterator vector<T>::erase(const_iterator pos)
+template<typename T, typename Allocator, size_t N>
+template<typename ForwardIt>
+typename vector<T, Allocator, N>::iterator vector<T, Allocator, N>::insert_range(size_t pos, ForwardIt first, ForwardIt last,
+                                                     std::forward_iterator_tag)
+{
+  size_t n = static_cast<size_t>(std::distance(first, last));
+  insert_n(pos, n, [this, n, first] (T *data) { copy_construct_range(data, n, first); });
+  return begin() + pos;
+}
+
+template<typename T, typename Allocator, size_t N>
+typename vector<T, Allocator, N>::iterator vector<T, Allocator, N>::erase(const_iterator pos)
 {
   return erase(pos, pos + 1);
 }
 
-template<typename T>
-typename vector<T>::iterator vector<T>::erase(const_iterator first, const_iterator last)
+template<typename T, typename Allocator, size_t N>
+typename vector<T, Allocator, N>::iterator vector<T, Allocator, N>::erase(const_iterator first, const_iterator last)
 {
   size_t l = static_cast<size_t>(first - begin()), r = static_cast<size_t>(last - begin());
-  size_t dst, src;
-  for (dst = l, src = r; src < size_; dst++, src++)
-    std::swap(data_[dst], data_[src]);
-  destroy_n(data_, dst, size_);
-  size_ -= r - l;
+  if (l != r)
+    erase_n(l, r, relocate_bitwise());
   return begin() + l;
 }
 
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::erase_n(size_t first, size_t last, std::true_type)
+{
+  destroy_n(data_, first, last);
+  std::memmove(static_cast<void *>(data_ + first), static_cast<const void *>(data_ + last),
+               (size_ - last) * sizeof(T));
+  size_ -= last - first;
+}
+
+template<typename T, typename Allocator, size_t N>
+void vector<T, Allocator, N>::erase_n(size_t first, size_t last, std::false_type)
+{
+  std::move(data_ + last, data_ + size_, data_ + first);
+  destroy_n(data_, size_ - (last - first), size_);
+  size_ -= last - first;
+}
+
 #endif // VECTOR_H